@@ -37,8 +37,13 @@
 #include "gpk-common.h"
 #include "gpk-common.h"
 #include "gpk-dialog.h"
+#include "gpk-details-cache.h"
 #include "gpk-enum.h"
 #include "gpk-error.h"
+#include "gpk-package-cache.h"
+#include "gpk-package-list-model.h"
+#include "gpk-scheduler.h"
+#include "gpk-string-pool.h"
 #include "gpk-task.h"
 #include "gpk-debug.h"
 
@@ -67,18 +72,36 @@ typedef enum {
 typedef struct {
 	gboolean		 has_package;
 	gboolean		 search_in_progress;
-	GCancellable		*cancellable;
+	gchar			*details_package_id;
+	PkClient		*prefetch_client;
+	guint			 prefetch_id;
+	guint			 search_generation;
+	guint			 search_timeout_id;
 	gchar			*homepage_url;
 	gchar			*search_group;
 	gchar			*search_text;
+	GHashTable		*packages_seen;
 	GHashTable		*repos;
+	GQueue			*load_queue;
+	guint			 load_id;
+	guint			 load_done;
+	guint			 load_total;
+	gboolean		 load_detached;
+	gboolean		 load_sealed;
+	gboolean		 load_search;
+	gboolean		 load_sort_saved;
+	gint			 load_sort_column;
+	GtkSortType		 load_sort_order;
 	GpkActionMode		 action;
 	GpkSearchMode		 search_mode;
 	GpkSearchType		 search_type;
 	GtkApplication		*application;
 	GSettings		*settings;
 	GtkBuilder		*builder;
-	GtkListStore		*packages_store;
+	GpkDetailsCache		*details_cache;
+	GpkPackageCache		*package_cache;
+	GpkPackageListModel	*packages_store;
+	GpkScheduler		*scheduler;
 	GtkTreeStore		*groups_store;
 	guint			 details_event_id;
 	guint			 status_id;
@@ -98,17 +121,6 @@ enum {
 	GPK_STATE_UNKNOWN
 };
 
-enum {
-	PACKAGES_COLUMN_IMAGE,
-	PACKAGES_COLUMN_STATE,  /* state of the item */
-	PACKAGES_COLUMN_CHECKBOX,  /* what we show in the checkbox */
-	PACKAGES_COLUMN_CHECKBOX_VISIBLE, /* visible */
-	PACKAGES_COLUMN_TEXT,
-	PACKAGES_COLUMN_ID,
-	PACKAGES_COLUMN_SUMMARY,
-	PACKAGES_COLUMN_LAST
-};
-
 enum {
 	GROUPS_COLUMN_ICON,
 	GROUPS_COLUMN_NAME,
@@ -119,6 +131,8 @@ enum {
 };
 
 static void gpk_application_perform_search (GpkApplicationPrivate *priv);
+static void gpk_application_loader_push (GpkApplicationPrivate *priv, PkPackage *package);
+static void gpk_application_prefetch_schedule (GpkApplicationPrivate *priv);
 
 static void gpk_application_get_requires_cb (PkClient *client, GAsyncResult *res, GpkApplicationPrivate *priv);
 static void gpk_application_get_depends_cb (PkClient *client, GAsyncResult *res, GpkApplicationPrivate *priv);
@@ -231,19 +245,17 @@ gpk_application_packages_checkbox_invert (GpkApplicationPrivate *priv)
 	}
 
 	gtk_tree_model_get (model, &iter,
-			    PACKAGES_COLUMN_STATE, &state,
-			    PACKAGES_COLUMN_ID, &package_id,
+			    GPK_PACKAGE_LIST_COLUMN_STATE, &state,
+			    GPK_PACKAGE_LIST_COLUMN_ID, &package_id,
 			    -1);
 
 	/* do something with the value */
 	pk_bitfield_invert (state, GPK_STATE_IN_LIST);
 
 	/* set new value */
-	gtk_list_store_set (GTK_LIST_STORE (model), &iter,
-			    PACKAGES_COLUMN_STATE, state,
-			    PACKAGES_COLUMN_CHECKBOX, gpk_application_state_get_checkbox (state),
-			    PACKAGES_COLUMN_IMAGE, gpk_application_state_get_icon (state),
-			    -1);
+	gpk_package_list_model_set_state (GPK_PACKAGE_LIST_MODEL (model), &iter, state,
+					  gpk_application_state_get_checkbox (state),
+					  gpk_application_state_get_icon (state));
 }
 
 static gboolean
@@ -283,12 +295,12 @@ gpk_application_get_selected_package (GpkApplicationPrivate *priv, gchar **packa
 	/* get data */
 	if (summary == NULL) {
 		gtk_tree_model_get (model, &iter,
-				    PACKAGES_COLUMN_ID, package_id,
+				    GPK_PACKAGE_LIST_COLUMN_ID, package_id,
 				    -1);
 	} else {
 		gtk_tree_model_get (model, &iter,
-				    PACKAGES_COLUMN_ID, package_id,
-				    PACKAGES_COLUMN_SUMMARY, summary,
+				    GPK_PACKAGE_LIST_COLUMN_ID, package_id,
+				    GPK_PACKAGE_LIST_COLUMN_SUMMARY, summary,
 				    -1);
 	}
 	return TRUE;
@@ -374,8 +386,8 @@ gpk_application_change_queue_status (GpkApplicationPrivate *priv)
 	while (valid) {
 		g_autofree gchar *package_id = NULL;
 		gtk_tree_model_get (model, &iter,
-				    PACKAGES_COLUMN_STATE, &state,
-				    PACKAGES_COLUMN_ID, &package_id,
+				    GPK_PACKAGE_LIST_COLUMN_STATE, &state,
+				    GPK_PACKAGE_LIST_COLUMN_ID, &package_id,
 				    -1);
 
 		/* we never show the checkbox for the search helper */
@@ -386,7 +398,7 @@ gpk_application_change_queue_status (GpkApplicationPrivate *priv)
 		}
 
 		/* set visible */
-		gtk_list_store_set (GTK_LIST_STORE (model), &iter, PACKAGES_COLUMN_CHECKBOX_VISIBLE, enabled, -1);
+		gpk_package_list_model_set_checkbox_visible (GPK_PACKAGE_LIST_MODEL (model), &iter, enabled);
 		valid = gtk_tree_model_iter_next (model, &iter);
 	}
 }
@@ -485,7 +497,8 @@ gpk_application_get_files_cb (PkClient *client, GAsyncResult *res, GpkApplicatio
 	/* get the results */
 	results = pk_client_generic_finish (client, res, &error);
 	if (results == NULL) {
-		g_warning ("failed to get files: %s", error->message);
+		if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+			g_warning ("failed to get files: %s", error->message);
 		return;
 	}
 
@@ -641,11 +654,23 @@ gpk_application_progress_cb (PkProgress *progress, PkProgressType type, GpkAppli
 	}
 }
 
+static void
+gpk_application_get_files_start (const gchar *package_id, GCancellable *cancellable,
+				 GAsyncReadyCallback callback, gpointer callback_data,
+				 GpkApplicationPrivate *priv)
+{
+	g_auto(GStrv) package_ids = NULL;
+
+	package_ids = pk_package_ids_from_id (package_id);
+	pk_client_get_files_async (PK_CLIENT (priv->task), package_ids, cancellable,
+				   (PkProgressCallback) gpk_application_progress_cb, priv,
+				   callback, callback_data);
+}
+
 static void
 gpk_application_menu_files_cb (GtkAction *action, GpkApplicationPrivate *priv)
 {
 	gboolean ret;
-	g_auto(GStrv) package_ids = NULL;
 	g_autofree gchar *package_id_selected = NULL;
 
 	/* get selection */
@@ -655,14 +680,11 @@ gpk_application_menu_files_cb (GtkAction *action, GpkApplicationPrivate *priv)
 		return;
 	}
 
-	/* ensure new action succeeds */
-	g_cancellable_reset (priv->cancellable);
-
 	/* set correct view */
-	package_ids = pk_package_ids_from_id (package_id_selected);
-	pk_client_get_files_async (PK_CLIENT (priv->task), package_ids, priv->cancellable,
-				   (PkProgressCallback) gpk_application_progress_cb, priv,
-				   (GAsyncReadyCallback) gpk_application_get_files_cb, priv);
+	gpk_scheduler_add (priv->scheduler, GPK_SCHEDULER_PRIORITY_INTERACTIVE,
+			   "get-files", package_id_selected,
+			   (GpkSchedulerFunc) gpk_application_get_files_start,
+			   (GAsyncReadyCallback) gpk_application_get_files_cb, priv);
 }
 
 static gboolean
@@ -755,7 +777,8 @@ gpk_application_get_requires_cb (PkClient *client, GAsyncResult *res, GpkApplica
 	/* get the results */
 	results = pk_client_generic_finish (client, res, &error);
 	if (results == NULL) {
-		g_warning ("failed to get requires: %s", error->message);
+		if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+			g_warning ("failed to get requires: %s", error->message);
 		return;
 	}
 
@@ -816,11 +839,25 @@ gpk_application_get_requires_cb (PkClient *client, GAsyncResult *res, GpkApplica
 	gtk_widget_destroy (GTK_WIDGET (dialog));
 }
 
+static void
+gpk_application_depends_on_start (const gchar *package_id, GCancellable *cancellable,
+				  GAsyncReadyCallback callback, gpointer callback_data,
+				  GpkApplicationPrivate *priv)
+{
+	g_auto(GStrv) package_ids = NULL;
+
+	package_ids = pk_package_ids_from_id (package_id);
+	pk_client_depends_on_async (PK_CLIENT (priv->task),
+				    pk_bitfield_value (PK_FILTER_ENUM_NONE),
+				    package_ids, TRUE, cancellable,
+				    (PkProgressCallback) gpk_application_progress_cb, priv,
+				    callback, callback_data);
+}
+
 static void
 gpk_application_menu_requires_cb (GtkAction *action, GpkApplicationPrivate *priv)
 {
 	gboolean ret;
-	g_auto(GStrv) package_ids = NULL;
 	g_autofree gchar *package_id_selected = NULL;
 
 	/* get selection */
@@ -830,17 +867,11 @@ gpk_application_menu_requires_cb (GtkAction *action, GpkApplicationPrivate *priv
 		return;
 	}
 
-	/* ensure new action succeeds */
-	g_cancellable_reset (priv->cancellable);
-
 	/* get the requires */
-	package_ids = pk_package_ids_from_id (package_id_selected);
-
-	pk_client_depends_on_async (PK_CLIENT (priv->task),
-				    pk_bitfield_value (PK_FILTER_ENUM_NONE),
-				    package_ids, TRUE, priv->cancellable,
-				    (PkProgressCallback) gpk_application_progress_cb, priv,
-				    (GAsyncReadyCallback) gpk_application_get_depends_cb, priv);
+	gpk_scheduler_add (priv->scheduler, GPK_SCHEDULER_PRIORITY_INTERACTIVE,
+			   "depends-on", package_id_selected,
+			   (GpkSchedulerFunc) gpk_application_depends_on_start,
+			   (GAsyncReadyCallback) gpk_application_get_depends_cb, priv);
 }
 
 static void
@@ -862,7 +893,8 @@ gpk_application_get_depends_cb (PkClient *client, GAsyncResult *res, GpkApplicat
 	/* get the results */
 	results = pk_client_generic_finish (client, res, &error);
 	if (results == NULL) {
-		g_warning ("failed to get depends: %s", error->message);
+		if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+			g_warning ("failed to get depends: %s", error->message);
 		return;
 	}
 
@@ -923,11 +955,25 @@ gpk_application_get_depends_cb (PkClient *client, GAsyncResult *res, GpkApplicat
 	gtk_widget_destroy (GTK_WIDGET (dialog));
 }
 
+static void
+gpk_application_required_by_start (const gchar *package_id, GCancellable *cancellable,
+				   GAsyncReadyCallback callback, gpointer callback_data,
+				   GpkApplicationPrivate *priv)
+{
+	g_auto(GStrv) package_ids = NULL;
+
+	package_ids = pk_package_ids_from_id (package_id);
+	pk_client_required_by_async (PK_CLIENT (priv->task),
+				     pk_bitfield_value (PK_FILTER_ENUM_NONE),
+				     package_ids, TRUE, cancellable,
+				     (PkProgressCallback) gpk_application_progress_cb, priv,
+				     callback, callback_data);
+}
+
 static void
 gpk_application_menu_depends_cb (GtkAction *_action, GpkApplicationPrivate *priv)
 {
 	gboolean ret;
-	g_auto(GStrv) package_ids = NULL;
 	g_autofree gchar *package_id_selected = NULL;
 
 	/* get selection */
@@ -937,17 +983,11 @@ gpk_application_menu_depends_cb (GtkAction *_action, GpkApplicationPrivate *priv
 		return;
 	}
 
-	/* ensure new action succeeds */
-	g_cancellable_reset (priv->cancellable);
-
 	/* get the depends */
-	package_ids = pk_package_ids_from_id (package_id_selected);
-
-	pk_client_required_by_async (PK_CLIENT (priv->task),
-				     pk_bitfield_value (PK_FILTER_ENUM_NONE),
-				     package_ids, TRUE, priv->cancellable,
-				     (PkProgressCallback) gpk_application_progress_cb, priv,
-				     (GAsyncReadyCallback) gpk_application_get_requires_cb, priv);
+	gpk_scheduler_add (priv->scheduler, GPK_SCHEDULER_PRIORITY_INTERACTIVE,
+			   "required-by", package_id_selected,
+			   (GpkSchedulerFunc) gpk_application_required_by_start,
+			   (GAsyncReadyCallback) gpk_application_get_requires_cb, priv);
 }
 
 static const gchar *
@@ -1001,28 +1041,31 @@ gpk_application_clear_details (GpkApplicationPrivate *priv)
 				 "[GpkApplication] clear-details");
 }
 
+static void gpk_application_loader_stop (GpkApplicationPrivate *priv);
+
 static void
 gpk_application_clear_packages (GpkApplicationPrivate *priv)
 {
-	/* clear existing array */
+	/* clear existing array while the view may still be detached, so
+	 * restoring the sort column has no rows to sort */
 	priv->has_package = FALSE;
-	gtk_list_store_clear (priv->packages_store);
+	g_hash_table_remove_all (priv->packages_seen);
+	gpk_package_list_model_clear (priv->packages_store);
+
+	/* drop anything still waiting to be added */
+	gpk_application_loader_stop (priv);
 }
 
 static void
 gpk_application_add_item_to_results (GpkApplicationPrivate *priv, PkPackage *item)
 {
-	GtkTreeIter iter;
-	g_autofree gchar *text = NULL;
 	gboolean in_queue;
 	gboolean installed;
 	gboolean enabled;
 	PkBitfield state = 0;
-	static guint package_cnt = 0;
 	PkInfoEnum info;
 	g_autofree gchar *package_id = NULL;
 	g_autofree gchar *summary = NULL;
-	GtkWidget *widget;
 
 	/* get data */
 	g_object_get (item,
@@ -1047,31 +1090,15 @@ gpk_application_add_item_to_results (GpkApplicationPrivate *priv, PkPackage *ite
 	if (info == PK_INFO_ENUM_COLLECTION_INSTALLED || info == PK_INFO_ENUM_COLLECTION_AVAILABLE)
 		pk_bitfield_add (state, GPK_STATE_COLLECTION);
 
-	/* use two lines */
-	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "window_manager"));
-	text = gpk_package_id_format_twoline (gtk_widget_get_style_context (widget),
-					      package_id,
-					      summary);
-
 	/* can we modify this? */
 	enabled = gpk_application_get_checkbox_enable (priv, state);
 
-	gtk_list_store_append (priv->packages_store, &iter);
-	gtk_list_store_set (priv->packages_store, &iter,
-			    PACKAGES_COLUMN_STATE, state,
-			    PACKAGES_COLUMN_CHECKBOX, gpk_application_state_get_checkbox (state),
-			    PACKAGES_COLUMN_CHECKBOX_VISIBLE, enabled,
-			    PACKAGES_COLUMN_TEXT, text,
-			    PACKAGES_COLUMN_SUMMARY, summary,
-			    PACKAGES_COLUMN_ID, package_id,
-			    PACKAGES_COLUMN_IMAGE, gpk_application_state_get_icon (state),
-			    -1);
-
-	/* only process every n events else we re-order too many times */
-	if (package_cnt++ % 200 == 0) {
-		while (gtk_events_pending ())
-			gtk_main_iteration ();
-	}
+	/* the two line markup is generated by the model when drawn */
+	gpk_package_list_model_append (priv->packages_store, NULL,
+				       package_id, summary, state,
+				       gpk_application_state_get_checkbox (state),
+				       enabled,
+				       gpk_application_state_get_icon (state));
 }
 
 static void
@@ -1080,9 +1107,7 @@ gpk_application_suggest_better_search (GpkApplicationPrivate *priv)
 	const gchar *message = NULL;
 	/* TRANSLATORS: no results were found for this search */
 	const gchar *title = _("No results were found.");
-	GtkTreeIter iter;
 	g_autofree gchar *text = NULL;
-	PkBitfield state = 0;
 
 	if (priv->search_mode == GPK_MODE_GROUP ||
 	    priv->search_mode == GPK_MODE_ALL_PACKAGES) {
@@ -1102,15 +1127,8 @@ gpk_application_suggest_better_search (GpkApplicationPrivate *priv)
 	}
 
 	text = g_strdup_printf ("%s\n%s", title, message);
-	gtk_list_store_append (priv->packages_store, &iter);
-	gtk_list_store_set (priv->packages_store, &iter,
-			    PACKAGES_COLUMN_STATE, state,
-			    PACKAGES_COLUMN_CHECKBOX, FALSE,
-			    PACKAGES_COLUMN_CHECKBOX_VISIBLE, FALSE,
-			    PACKAGES_COLUMN_TEXT, text,
-			    PACKAGES_COLUMN_IMAGE, "system-search",
-			    PACKAGES_COLUMN_ID, NULL,
-			    -1);
+	gpk_package_list_model_append_message (priv->packages_store, NULL,
+					       "system-search", text);
 }
 
 static gboolean
@@ -1144,12 +1162,12 @@ gpk_application_select_exact_match (GpkApplicationPrivate *priv, const gchar *te
 	/* for all items in treeview */
 	while (valid) {
 		g_autofree gchar *package_id = NULL;
-		gtk_tree_model_get (model, &iter, PACKAGES_COLUMN_ID, &package_id, -1);
+		gtk_tree_model_get (model, &iter, GPK_PACKAGE_LIST_COLUMN_ID, &package_id, -1);
 		if (package_id != NULL) {
-			g_auto(GStrv) split = NULL;
+			GpkPackageIdView view;
 			/* exact match, so select and scroll */
-			split = pk_package_id_split (package_id);
-			if (g_strcmp0 (split[PK_PACKAGE_ID_NAME], text) == 0) {
+			if (gpk_package_id_view_parse (&view, package_id) &&
+			    gpk_package_id_view_equal (&view, PK_PACKAGE_ID_NAME, text)) {
 				selection = gtk_tree_view_get_selection (treeview);
 				gtk_tree_selection_select_iter (selection, &iter);
 				path = gtk_tree_model_get_path (model, &iter);
@@ -1168,36 +1186,286 @@ gpk_application_select_exact_match (GpkApplicationPrivate *priv, const gchar *te
 static void
 gpk_application_cancel_cb (GtkWidget *button_widget, GpkApplicationPrivate *priv)
 {
-	g_cancellable_cancel (priv->cancellable);
+	gpk_scheduler_cancel_priority (priv->scheduler, GPK_SCHEDULER_PRIORITY_INTERACTIVE);
 
 	/* switch buttons around */
 	priv->search_mode = GPK_MODE_UNKNOWN;
 }
 
+/* roughly how much memory package details can use */
+#define GPK_APPLICATION_DETAILS_CACHE_SIZE	(2 * 1024 * 1024) /* bytes */
+/* wait for the cursor to settle before prefetching details */
+#define GPK_APPLICATION_PREFETCH_DELAY		150 /* ms */
+/* rows either side of the cursor to prefetch details for */
+#define GPK_APPLICATION_PREFETCH_ROWS		10
+/* most packages to ask for details of in one transaction */
+#define GPK_APPLICATION_PREFETCH_MAX		64
+
+/* how long to wait for more typing before searching */
+#define GPK_APPLICATION_SEARCH_DEBOUNCE		300 /* ms */
+/* shorter text is only searched for when the entry is activated */
+#define GPK_APPLICATION_SEARCH_MIN_LENGTH	2
+
+/* time we can spend adding rows before letting GTK draw a frame */
+#define GPK_APPLICATION_LOADER_BUDGET		8000 /* us */
+/* pending rows before we stop the view tracking each insert */
+#define GPK_APPLICATION_LOADER_DETACH_THRESHOLD	1000
+
 static void
-gpk_application_set_button_find_sensitivity (GpkApplicationPrivate *priv)
+gpk_application_search_reset_ui (GpkApplicationPrivate *priv)
 {
 	GtkWidget *widget;
 
-	/* only sensitive if not in the middle of a search */
+	priv->search_in_progress = FALSE;
+	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "scrolledwindow_groups"));
+	gtk_widget_set_sensitive (widget, TRUE);
+}
+
+static void
+gpk_application_search_finished (GpkApplicationPrivate *priv)
+{
+	GtkWidget *widget;
+
+	/* were there no entries found? */
+	if (!priv->has_package)
+		gpk_application_suggest_better_search (priv);
+
+	/* if there is an exact match, select it */
+	gpk_application_select_exact_match (priv, priv->search_text);
+	gpk_application_prefetch_schedule (priv);
+
+	/* focus back to the text extry */
 	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "entry_text"));
-	gtk_widget_set_sensitive (widget, !priv->search_in_progress);
+	gtk_widget_grab_focus (widget);
+
+	/* reset UI */
+	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "treeview_groups"));
+	gtk_widget_set_sensitive (widget, TRUE);
+	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "textview_description"));
+	gtk_widget_set_sensitive (widget, TRUE);
+	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "entry_text"));
+	gtk_widget_set_sensitive (widget, TRUE);
+	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "button_apply"));
+	gtk_widget_set_sensitive (widget, TRUE);
+	gpk_application_search_reset_ui (priv);
 }
 
 static void
-gpk_application_search_cb (PkClient *client, GAsyncResult *res, GpkApplicationPrivate *priv)
+gpk_application_loader_done (GpkApplicationPrivate *priv)
 {
+	GtkWidget *widget;
+	PkPackage *package;
+
+	if (priv->load_id > 0) {
+		g_source_remove (priv->load_id);
+		priv->load_id = 0;
+	}
+	while ((package = g_queue_pop_head (priv->load_queue)) != NULL)
+		g_object_unref (package);
+
+	/* sort everything in one go */
+	if (priv->load_sort_saved) {
+		gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (priv->packages_store),
+						      priv->load_sort_column,
+						      priv->load_sort_order);
+		priv->load_sort_saved = FALSE;
+	}
+
+	/* show the rows again */
+	if (priv->load_detached) {
+		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "treeview_packages"));
+		gtk_tree_view_set_model (GTK_TREE_VIEW (widget),
+					 GTK_TREE_MODEL (priv->packages_store));
+		priv->load_detached = FALSE;
+	}
+
+	if (priv->load_sealed) {
+		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "headerbar"));
+		gtk_header_bar_set_subtitle (GTK_HEADER_BAR (widget), NULL);
+	}
+
+	if (priv->load_total > 0)
+		g_debug ("added %u of %u packages", priv->load_done, priv->load_total);
+	priv->load_done = 0;
+	priv->load_total = 0;
+	priv->load_sealed = FALSE;
+}
+
+static void
+gpk_application_loader_stop (GpkApplicationPrivate *priv)
+{
+	gboolean search = priv->load_sealed && priv->load_search;
+
+	gpk_application_loader_done (priv);
+
+	/* the search callback has already returned, so nothing else will */
+	if (search)
+		gpk_application_search_reset_ui (priv);
+}
+
+static void
+gpk_application_loader_show_progress (GpkApplicationPrivate *priv)
+{
+	GtkWidget *widget;
+	g_autofree gchar *text = NULL;
+
+	/* the transaction status is shown until then */
+	if (!priv->load_sealed && !priv->load_detached)
+		return;
+
+	/* TRANSLATORS: the package list is being filled in, e.g. "Adding packages (200 of 70000)" */
+	text = g_strdup_printf (_("Adding packages (%u of %u)"),
+				priv->load_done, priv->load_total);
+	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "headerbar"));
+	gtk_header_bar_set_subtitle (GTK_HEADER_BAR (widget), text);
+}
+
+static gboolean
+gpk_application_loader_idle_cb (GpkApplicationPrivate *priv)
+{
+	gboolean search;
+	gint64 start;
+	PkPackage *package;
+
+	/* add as many rows as we can without dropping a frame */
+	start = g_get_monotonic_time ();
+	while ((package = g_queue_pop_head (priv->load_queue)) != NULL) {
+		gpk_application_add_item_to_results (priv, package);
+		g_object_unref (package);
+		priv->load_done++;
+		if (g_get_monotonic_time () - start > GPK_APPLICATION_LOADER_BUDGET)
+			break;
+	}
+
+	/* more to do */
+	if (!g_queue_is_empty (priv->load_queue)) {
+		gpk_application_loader_show_progress (priv);
+		return TRUE;
+	}
+
+	/* the transaction is still sending packages */
+	priv->load_id = 0;
+	if (!priv->load_sealed)
+		return FALSE;
+
+	/* everything is in the list */
+	search = priv->load_search;
+	gpk_application_loader_done (priv);
+	if (search)
+		gpk_application_search_finished (priv);
+	return FALSE;
+}
+
+static void
+gpk_application_loader_schedule (GpkApplicationPrivate *priv)
+{
+	if (priv->load_id > 0)
+		return;
+	priv->load_id = g_idle_add ((GSourceFunc) gpk_application_loader_idle_cb, priv);
+	g_source_set_name_by_id (priv->load_id, "[GpkApplication] loader");
+}
+
+static void
+gpk_application_loader_push (GpkApplicationPrivate *priv, PkPackage *package)
+{
+	GtkWidget *widget;
+	const gchar *package_id;
+
+	/* already added when it was streamed from the progress callback */
+	package_id = pk_package_get_id (package);
+	if (g_hash_table_contains (priv->packages_seen, package_id))
+		return;
+	g_hash_table_add (priv->packages_seen, g_strdup (package_id));
+
+	/* don't re-sort the list for every row we add */
+	if (!priv->load_sort_saved) {
+		gtk_tree_sortable_get_sort_column_id (GTK_TREE_SORTABLE (priv->packages_store),
+						      &priv->load_sort_column,
+						      &priv->load_sort_order);
+		gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (priv->packages_store),
+						      GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID,
+						      priv->load_sort_order);
+		priv->load_sort_saved = TRUE;
+	}
+
+	g_queue_push_tail (priv->load_queue, g_object_ref (package));
+	priv->load_total++;
+
+	/* a large backlog is much quicker to add with the view detached */
+	if (!priv->load_detached &&
+	    g_queue_get_length (priv->load_queue) > GPK_APPLICATION_LOADER_DETACH_THRESHOLD) {
+		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "treeview_packages"));
+		gtk_tree_view_set_model (GTK_TREE_VIEW (widget), NULL);
+		priv->load_detached = TRUE;
+	}
+
+	gpk_application_loader_schedule (priv);
+}
+
+static void
+gpk_application_loader_seal (GpkApplicationPrivate *priv, gboolean search)
+{
+	/* finish off once the queue is empty */
+	priv->load_sealed = TRUE;
+	priv->load_search = search;
+	gpk_application_loader_schedule (priv);
+}
+
+typedef struct {
+	GpkApplicationPrivate	*priv;
+	guint			 generation;
+} GpkApplicationSearch;
+
+static GpkApplicationSearch *
+gpk_application_search_new (GpkApplicationPrivate *priv)
+{
+	GpkApplicationSearch *search;
+	search = g_new0 (GpkApplicationSearch, 1);
+	search->priv = priv;
+	search->generation = priv->search_generation;
+	return search;
+}
+
+static void
+gpk_application_search_progress_cb (PkProgress *progress, PkProgressType type,
+				    GpkApplicationSearch *search)
+{
+	/* a newer search owns the UI now */
+	if (search->generation != search->priv->search_generation)
+		return;
+
+	/* show the row now rather than when the transaction finishes */
+	if (type == PK_PROGRESS_TYPE_PACKAGE) {
+		g_autoptr(PkPackage) package = NULL;
+		g_object_get (progress, "package", &package, NULL);
+		if (package != NULL)
+			gpk_application_loader_push (search->priv, package);
+		return;
+	}
+	gpk_application_progress_cb (progress, type, search->priv);
+}
+
+static void
+gpk_application_search_cb (PkClient *client, GAsyncResult *res, GpkApplicationSearch *search)
+{
+	GpkApplicationPrivate *priv = search->priv;
+	g_autofree GpkApplicationSearch *search_tmp = search;
 	g_autoptr(PkResults) results = NULL;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(PkError) error_code = NULL;
 	g_autoptr(GPtrArray) array = NULL;
 	PkPackage *item;
 	guint i;
-	GtkWidget *widget;
 	GtkWindow *window;
 
 	/* get the results */
 	results = pk_client_generic_finish (client, res, &error);
+
+	/* this search was cancelled for a newer one */
+	if (search->generation != priv->search_generation) {
+		g_debug ("ignoring results from search %u", search->generation);
+		return;
+	}
 	if (results == NULL) {
 		g_warning ("failed to search: %s", error->message);
 		goto out;
@@ -1217,39 +1485,308 @@ gpk_application_search_cb (PkClient *client, GAsyncResult *res, GpkApplicationPr
 		goto out;
 	}
 
-	/* get data */
+	/* add anything that was not already streamed */
 	array = pk_results_get_package_array (results);
 	for (i = 0; i < array->len; i++) {
 		item = g_ptr_array_index (array, i);
-		gpk_application_add_item_to_results (priv, item);
+		gpk_application_loader_push (priv, item);
 	}
 
-	/* were there no entries found? */
-	if (!priv->has_package)
-		gpk_application_suggest_better_search (priv);
+	/* remember for next time */
+	if (priv->search_mode == GPK_MODE_GROUP) {
+		gpk_package_cache_add_packages (priv->package_cache, priv->filters_current,
+						priv->search_group, array);
+	} else if (priv->search_mode == GPK_MODE_ALL_PACKAGES) {
+		gpk_package_cache_add_packages (priv->package_cache, priv->filters_current,
+						NULL, array);
+	}
 
-	/* if there is an exact match, select it */
-	gpk_application_select_exact_match (priv, priv->search_text);
+	/* the rest of the UI is reset when the last row has been added */
+	gpk_application_loader_seal (priv, TRUE);
+	return;
+out:
+	/* drop anything streamed but not yet shown */
+	gpk_application_loader_done (priv);
+	gpk_application_search_reset_ui (priv);
+}
 
-	/* focus back to the text extry */
-	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "entry_text"));
-	gtk_widget_grab_focus (widget);
+typedef struct {
+	GpkApplicationPrivate	*priv;
+	GpkSearchMode		 mode;
+	GpkSearchType		 type;
+	PkBitfield		 filters;
+	gchar			*group;		/* NULL for all packages */
+	gchar			*text;
+	gboolean		 cacheable;
+	guint			 generation;	/* zero if nothing was shown */
+} GpkApplicationCacheRefresh;
 
-	/* reset UI */
-	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "treeview_groups"));
-	gtk_widget_set_sensitive (widget, TRUE);
-	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "textview_description"));
-	gtk_widget_set_sensitive (widget, TRUE);
-	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "entry_text"));
-	gtk_widget_set_sensitive (widget, TRUE);
-	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "button_apply"));
-	gtk_widget_set_sensitive (widget, TRUE);
+static void
+gpk_application_cache_refresh_free (GpkApplicationCacheRefresh *refresh)
+{
+	g_free (refresh->group);
+	g_free (refresh->text);
+	g_free (refresh);
+}
+
+static gboolean
+gpk_application_packages_shown (GpkApplicationPrivate *priv, GPtrArray *array)
+{
+	PkPackage *item;
+	guint i;
+
+	if (array->len != g_hash_table_size (priv->packages_seen))
+		return FALSE;
+	for (i = 0; i < array->len; i++) {
+		item = g_ptr_array_index (array, i);
+		if (!g_hash_table_contains (priv->packages_seen, pk_package_get_id (item)))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static void
+gpk_application_cache_refresh_cb (PkClient *client, GAsyncResult *res,
+				  GpkApplicationCacheRefresh *refresh)
+{
+	GpkApplicationPrivate *priv = refresh->priv;
+	PkPackage *item;
+	gboolean changed = FALSE;
+	guint i;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) array = NULL;
+	g_autoptr(PkError) error_code = NULL;
+	g_autoptr(PkResults) results = NULL;
+
+	/* get the results */
+	results = pk_client_generic_finish (client, res, &error);
+	if (results == NULL) {
+		g_debug ("failed to refresh cache: %s", error->message);
+		goto out;
+	}
+	error_code = pk_results_get_error_code (results);
+	if (error_code != NULL) {
+		g_debug ("failed to refresh cache: %s", pk_error_get_details (error_code));
+		goto out;
+	}
+
+	/* update the cache */
+	array = pk_results_get_package_array (results);
+	if (refresh->cacheable) {
+		changed = gpk_package_cache_add_packages (priv->package_cache, refresh->filters,
+							  refresh->group, array);
+	}
+
+	/* the user has moved on */
+	if (refresh->generation == 0 || refresh->generation != priv->search_generation)
+		goto out;
+	if (!changed && gpk_application_packages_shown (priv, array))
+		goto out;
+
+	/* show what PackageKit told us instead */
+	g_debug ("cached results were out of date");
+	gpk_application_clear_packages (priv);
+	priv->search_in_progress = TRUE;
+	for (i = 0; i < array->len; i++) {
+		item = g_ptr_array_index (array, i);
+		gpk_application_loader_push (priv, item);
+	}
+	gpk_application_loader_seal (priv, TRUE);
 out:
-	/* mark find button sensitive */
-	priv->search_in_progress = FALSE;
-	gpk_application_set_button_find_sensitivity (priv);
-	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "scrolledwindow_groups"));
-	gtk_widget_set_sensitive (widget, TRUE);
+	gpk_application_cache_refresh_free (refresh);
+}
+
+static void
+gpk_application_cache_refresh_start (const gchar *key, GCancellable *cancellable,
+				     GAsyncReadyCallback callback, gpointer callback_data,
+				     GpkApplicationCacheRefresh *refresh)
+{
+	GpkApplicationPrivate *priv = refresh->priv;
+	g_auto(GStrv) values = NULL;
+
+	/* no progress callback, so nothing is shown until it is done */
+	if (refresh->mode == GPK_MODE_GROUP) {
+		values = g_strsplit (refresh->group, " ", -1);
+		pk_client_search_groups_async (PK_CLIENT(priv->task),
+					       refresh->filters, values, cancellable,
+					       NULL, NULL,
+					       callback, callback_data);
+	} else if (refresh->mode == GPK_MODE_NAME_DETAILS_FILE) {
+		values = g_strsplit (refresh->text, " ", -1);
+		if (refresh->type == GPK_SEARCH_DETAILS) {
+			pk_client_search_details_async (PK_CLIENT(priv->task),
+							refresh->filters, values, cancellable,
+							NULL, NULL,
+							callback, callback_data);
+		} else {
+			pk_client_search_names_async (PK_CLIENT(priv->task),
+						      refresh->filters, values, cancellable,
+						      NULL, NULL,
+						      callback, callback_data);
+		}
+	} else {
+		pk_client_get_packages_async (PK_CLIENT(priv->task),
+					      refresh->filters, cancellable,
+					      NULL, NULL,
+					      callback, callback_data);
+	}
+}
+
+static void
+gpk_application_cache_refresh (GpkApplicationPrivate *priv, GpkSearchMode mode, guint generation)
+{
+	GpkApplicationCacheRefresh *refresh;
+	g_autofree gchar *key = NULL;
+
+	refresh = g_new0 (GpkApplicationCacheRefresh, 1);
+	refresh->priv = priv;
+	refresh->mode = mode;
+	refresh->type = priv->search_type;
+	refresh->filters = priv->filters_current;
+	refresh->generation = generation;
+	if (mode == GPK_MODE_GROUP) {
+		refresh->group = g_strdup (priv->search_group);
+		refresh->cacheable = TRUE;
+	} else if (mode == GPK_MODE_NAME_DETAILS_FILE) {
+		refresh->text = g_strdup (priv->search_text);
+	} else {
+		refresh->cacheable = TRUE;
+	}
+
+	/* refilling the cache after it was invalidated can be merged */
+	key = g_strdup_printf ("%u:%i:%i:%" G_GUINT64_FORMAT ":%s",
+			       generation, mode, refresh->type, refresh->filters,
+			       refresh->group != NULL ? refresh->group :
+			       refresh->text != NULL ? refresh->text : "");
+	if (!gpk_scheduler_add (priv->scheduler, GPK_SCHEDULER_PRIORITY_BACKGROUND,
+				generation > 0 ? "cache-refresh" : "cache-refill", key,
+				(GpkSchedulerFunc) gpk_application_cache_refresh_start,
+				(GAsyncReadyCallback) gpk_application_cache_refresh_cb,
+				refresh))
+		gpk_application_cache_refresh_free (refresh);
+}
+
+static gboolean
+gpk_application_search_from_cache (GpkApplicationPrivate *priv)
+{
+	PkPackage *item;
+	guint i;
+	g_autoptr(GPtrArray) array = NULL;
+
+	if (priv->search_mode == GPK_MODE_GROUP) {
+		array = gpk_package_cache_get_packages (priv->package_cache,
+							priv->filters_current,
+							priv->search_group);
+	} else if (priv->search_mode == GPK_MODE_ALL_PACKAGES) {
+		array = gpk_package_cache_get_packages (priv->package_cache,
+							priv->filters_current,
+							NULL);
+	} else if (priv->search_mode == GPK_MODE_NAME_DETAILS_FILE) {
+		g_auto(GStrv) searches = g_strsplit (priv->search_text, " ", -1);
+		if (priv->search_type == GPK_SEARCH_NAME) {
+			array = gpk_package_cache_search_names (priv->package_cache,
+								priv->filters_current,
+								searches);
+		} else if (priv->search_type == GPK_SEARCH_DETAILS) {
+			array = gpk_package_cache_search_details (priv->package_cache,
+								  priv->filters_current,
+								  searches);
+		}
+	}
+	if (array == NULL)
+		return FALSE;
+
+	/* show the cached results now and check them in the background */
+	g_debug ("using %u cached results", array->len);
+	priv->search_in_progress = TRUE;
+	for (i = 0; i < array->len; i++) {
+		item = g_ptr_array_index (array, i);
+		gpk_application_loader_push (priv, item);
+	}
+	gpk_application_loader_seal (priv, TRUE);
+	gpk_application_cache_refresh (priv, priv->search_mode, priv->search_generation);
+	return TRUE;
+}
+
+static void
+gpk_application_search_start (const gchar *key, GCancellable *cancellable,
+			      GAsyncReadyCallback callback, gpointer callback_data,
+			      GpkApplicationSearch *search)
+{
+	GpkApplicationPrivate *priv = search->priv;
+	g_auto(GStrv) values = NULL;
+
+	if (priv->search_mode == GPK_MODE_GROUP) {
+		values = g_strsplit (priv->search_group, " ", -1);
+		pk_client_search_groups_async (PK_CLIENT(priv->task),
+					       priv->filters_current, values, cancellable,
+					       (PkProgressCallback) gpk_application_search_progress_cb, search,
+					       callback, callback_data);
+	} else if (priv->search_mode == GPK_MODE_ALL_PACKAGES) {
+		pk_client_get_packages_async (PK_CLIENT(priv->task),
+					      priv->filters_current, cancellable,
+					      (PkProgressCallback) gpk_application_search_progress_cb, search,
+					      callback, callback_data);
+	} else if (priv->search_type == GPK_SEARCH_NAME) {
+		values = g_strsplit (priv->search_text, " ", -1);
+		pk_task_search_names_async (priv->task,
+					     priv->filters_current,
+					     values, cancellable,
+					     (PkProgressCallback) gpk_application_search_progress_cb, search,
+					     callback, callback_data);
+	} else if (priv->search_type == GPK_SEARCH_DETAILS) {
+		values = g_strsplit (priv->search_text, " ", -1);
+		pk_task_search_details_async (priv->task,
+					     priv->filters_current,
+					     values, cancellable,
+					     (PkProgressCallback) gpk_application_search_progress_cb, search,
+					     callback, callback_data);
+	} else {
+		values = g_strsplit (priv->search_text, " ", -1);
+		pk_task_search_files_async (priv->task,
+					     priv->filters_current,
+					     values, cancellable,
+					     (PkProgressCallback) gpk_application_search_progress_cb, search,
+					     callback, callback_data);
+	}
+}
+
+static gchar *
+gpk_application_search_key (GpkApplicationPrivate *priv)
+{
+	GtkEntry *entry;
+
+	if (priv->search_mode == GPK_MODE_NAME_DETAILS_FILE) {
+		entry = GTK_ENTRY (gtk_builder_get_object (priv->builder, "entry_text"));
+		return g_strdup_printf ("text:%i:%" G_GUINT64_FORMAT ":%s",
+					priv->search_type, priv->filters_current,
+					gtk_entry_get_text (entry));
+	}
+	if (priv->search_mode == GPK_MODE_GROUP) {
+		return g_strdup_printf ("group:%" G_GUINT64_FORMAT ":%s",
+					priv->filters_current, priv->search_group);
+	}
+	if (priv->search_mode == GPK_MODE_ALL_PACKAGES) {
+		return g_strdup_printf ("all:%" G_GUINT64_FORMAT,
+					priv->filters_current);
+	}
+	return NULL;
+}
+
+static void
+gpk_application_search_schedule (GpkApplicationPrivate *priv)
+{
+	GpkApplicationSearch *search;
+	g_autofree gchar *key = NULL;
+
+	priv->search_in_progress = TRUE;
+	key = gpk_application_search_key (priv);
+	search = gpk_application_search_new (priv);
+	if (!gpk_scheduler_add (priv->scheduler, GPK_SCHEDULER_PRIORITY_INTERACTIVE,
+				"search", key,
+				(GpkSchedulerFunc) gpk_application_search_start,
+				(GAsyncReadyCallback) gpk_application_search_cb, search))
+		g_free (search);
 }
 
 static void
@@ -1259,7 +1796,6 @@ gpk_application_perform_search_name_details_file (GpkApplicationPrivate *priv)
 	GtkWindow *window;
 	g_autoptr(GError) error = NULL;
 	gboolean ret;
-	g_auto(GStrv) searches = NULL;
 
 	entry = GTK_ENTRY (gtk_builder_get_object (priv->builder, "entry_text"));
 	g_free (priv->search_text);
@@ -1285,38 +1821,20 @@ gpk_application_perform_search_name_details_file (GpkApplicationPrivate *priv)
 	}
 	g_debug ("find %s", priv->search_text);
 
-	/* mark find button insensitive */
-	priv->search_in_progress = TRUE;
-	gpk_application_set_button_find_sensitivity (priv);
-
-	/* ensure new action succeeds */
-	g_cancellable_reset (priv->cancellable);
-
-	/* do the search */
-	searches = g_strsplit (priv->search_text, " ", -1);
-	if (priv->search_type == GPK_SEARCH_NAME) {
-		pk_task_search_names_async (priv->task,
-					     priv->filters_current,
-					     searches, priv->cancellable,
-					     (PkProgressCallback) gpk_application_progress_cb, priv,
-					     (GAsyncReadyCallback) gpk_application_search_cb, priv);
-	} else if (priv->search_type == GPK_SEARCH_DETAILS) {
-		pk_task_search_details_async (priv->task,
-					     priv->filters_current,
-					     searches, priv->cancellable,
-					     (PkProgressCallback) gpk_application_progress_cb, priv,
-					     (GAsyncReadyCallback) gpk_application_search_cb, priv);
-	} else if (priv->search_type == GPK_SEARCH_FILE) {
-		pk_task_search_files_async (priv->task,
-					     priv->filters_current,
-					     searches, priv->cancellable,
-					     (PkProgressCallback) gpk_application_progress_cb, priv,
-					     (GAsyncReadyCallback) gpk_application_search_cb, priv);
-	} else {
+	if (priv->search_type != GPK_SEARCH_NAME &&
+	    priv->search_type != GPK_SEARCH_DETAILS &&
+	    priv->search_type != GPK_SEARCH_FILE) {
 		g_warning ("invalid search type");
 		return;
 	}
 
+	/* we might already know */
+	if (gpk_application_search_from_cache (priv))
+		return;
+
+	/* do the search */
+	gpk_application_search_schedule (priv);
+
 	if (!ret) {
 		window = GTK_WINDOW (gtk_builder_get_object (priv->builder, "window_manager"));
 		gpk_error_dialog_modal (window,
@@ -1331,24 +1849,11 @@ gpk_application_perform_search_name_details_file (GpkApplicationPrivate *priv)
 static void
 gpk_application_perform_search_others (GpkApplicationPrivate *priv)
 {
-	/* ensure new action succeeds */
-	g_cancellable_reset (priv->cancellable);
-
-	priv->search_in_progress = TRUE;
+	/* we might already know */
+	if (gpk_application_search_from_cache (priv))
+		return;
 
-	if (priv->search_mode == GPK_MODE_GROUP) {
-		g_auto(GStrv) search_groups = NULL;
-		search_groups = g_strsplit (priv->search_group, " ", -1);
-		pk_client_search_groups_async (PK_CLIENT(priv->task),
-					       priv->filters_current, search_groups, priv->cancellable,
-					       (PkProgressCallback) gpk_application_progress_cb, priv,
-					       (GAsyncReadyCallback) gpk_application_search_cb, priv);
-	} else {
-		pk_client_get_packages_async (PK_CLIENT(priv->task),
-					      priv->filters_current, priv->cancellable,
-					      (PkProgressCallback) gpk_application_progress_cb, priv,
-					      (GAsyncReadyCallback) gpk_application_search_cb, priv);
-	}
+	gpk_application_search_schedule (priv);
 }
 
 static gboolean
@@ -1370,23 +1875,37 @@ gpk_application_populate_selected (GpkApplicationPrivate *priv)
 	/* dump queue to package window */
 	for (i = 0; i < array->len; i++) {
 		package = g_ptr_array_index (array, i);
-		gpk_application_add_item_to_results (priv, package);
+		gpk_application_loader_push (priv, package);
 	}
+	gpk_application_loader_seal (priv, FALSE);
 	return TRUE;
 }
 
 static void
 gpk_application_perform_search (GpkApplicationPrivate *priv)
 {
-	/*if we are in the middle of a search, just return*/
-	if (priv->search_in_progress == TRUE)
-		return;
+	g_autofree gchar *key = NULL;
 
 	/* just shown the welcome screen */
 	if (priv->search_mode == GPK_MODE_UNKNOWN)
 		return;
 
+	/* the results are already on their way */
+	key = gpk_application_search_key (priv);
+	if (key != NULL && gpk_scheduler_contains (priv->scheduler, "search", key)) {
+		g_debug ("already searching for %s", key);
+		return;
+	}
+
+	/* a new search replaces the one in progress */
+	if (priv->search_in_progress) {
+		g_debug ("cancelling search %u", priv->search_generation);
+		gpk_scheduler_cancel (priv->scheduler, "search");
+		priv->search_in_progress = FALSE;
+	}
+
 	g_debug ("CLEAR search");
+	priv->search_generation++;
 	gpk_application_clear_details (priv);
 	gpk_application_clear_packages (priv);
 
@@ -1405,6 +1924,11 @@ gpk_application_perform_search (GpkApplicationPrivate *priv)
 static void
 gpk_application_find_cb (GtkWidget *button_widget, GpkApplicationPrivate *priv)
 {
+	/* don't wait for the user to stop typing */
+	if (priv->search_timeout_id > 0) {
+		g_source_remove (priv->search_timeout_id);
+		priv->search_timeout_id = 0;
+	}
 	priv->search_mode = GPK_MODE_NAME_DETAILS_FILE;
 	gpk_application_perform_search (priv);
 }
@@ -1444,11 +1968,20 @@ gpk_application_quit (GpkApplicationPrivate *priv)
 	}
 
 	/* we might have visual stuff running, close them down */
-	g_cancellable_cancel (priv->cancellable);
+	gpk_scheduler_cancel_all (priv->scheduler);
 	g_application_release (G_APPLICATION (priv->application));
 	return TRUE;
 }
 
+static gboolean
+gpk_application_search_timeout_cb (GpkApplicationPrivate *priv)
+{
+	priv->search_timeout_id = 0;
+	priv->search_mode = GPK_MODE_NAME_DETAILS_FILE;
+	gpk_application_perform_search (priv);
+	return FALSE;
+}
+
 static gboolean
 gpk_application_text_changed_cb (GtkEntry *entry, GpkApplicationPrivate *priv)
 {
@@ -1463,8 +1996,19 @@ gpk_application_text_changed_cb (GtkEntry *entry, GpkApplicationPrivate *priv)
 		gtk_tree_selection_unselect_all (selection);
 	}
 
-	/* mark find button sensitive */
-	gpk_application_set_button_find_sensitivity (priv);
+	/* search once the user stops typing */
+	if (priv->search_timeout_id > 0) {
+		g_source_remove (priv->search_timeout_id);
+		priv->search_timeout_id = 0;
+	}
+	if (gtk_entry_get_text_length (entry) < GPK_APPLICATION_SEARCH_MIN_LENGTH)
+		return FALSE;
+	priv->search_timeout_id =
+		g_timeout_add (GPK_APPLICATION_SEARCH_DEBOUNCE,
+			       (GSourceFunc) gpk_application_search_timeout_cb,
+			       priv);
+	g_source_set_name_by_id (priv->search_timeout_id,
+				 "[GpkApplication] search-as-you-type");
 	return FALSE;
 }
 
@@ -1485,7 +2029,7 @@ gpk_application_packages_installed_clicked_cb (GtkCellRendererToggle *cell, gcha
 	/* get toggled iter */
 	gtk_tree_model_get_iter (model, &iter, path);
 	gtk_tree_model_get (model, &iter,
-			    PACKAGES_COLUMN_STATE, &state,
+			    GPK_PACKAGE_LIST_COLUMN_STATE, &state,
 			    -1);
 
 	/* enforce the selection in case we just fire at the checkbox without selecting */
@@ -1522,7 +2066,7 @@ gpk_application_button_clear_cb (GtkWidget *widget_button, GpkApplicationPrivate
 
 	/* for all current items, reset the state if in the array */
 	while (valid) {
-		gtk_tree_model_get (model, &iter, PACKAGES_COLUMN_STATE, &state, -1);
+		gtk_tree_model_get (model, &iter, GPK_PACKAGE_LIST_COLUMN_STATE, &state, -1);
 		ret = pk_bitfield_contain (state, GPK_STATE_IN_LIST);
 		if (ret) {
 			pk_bitfield_remove (state, GPK_STATE_IN_LIST);
@@ -1531,11 +2075,8 @@ gpk_application_button_clear_cb (GtkWidget *widget_button, GpkApplicationPrivate
 			checkbox = gpk_application_state_get_checkbox (state);
 
 			/* set new value */
-			gtk_list_store_set (GTK_LIST_STORE (model), &iter,
-					    PACKAGES_COLUMN_STATE, state,
-					    PACKAGES_COLUMN_CHECKBOX, checkbox,
-					    PACKAGES_COLUMN_IMAGE, icon,
-					    -1);
+			gpk_package_list_model_set_state (GPK_PACKAGE_LIST_MODEL (model),
+							  &iter, state, checkbox, icon);
 		}
 		valid = gtk_tree_model_iter_next (model, &iter);
 	}
@@ -1581,6 +2122,11 @@ gpk_application_install_packages_cb (PkTask *task, GAsyncResult *res, GpkApplica
 		return;
 	}
 
+	/* the cached info is now wrong */
+	gpk_package_cache_invalidate (priv->package_cache);
+	gpk_details_cache_invalidate (priv->details_cache);
+	gpk_scheduler_cancel (priv->scheduler, "prefetch");
+
 	/* idle add in the background */
 	idle_id = g_idle_add ((GSourceFunc) gpk_application_perform_search_idle_cb, priv);
 	g_source_set_name_by_id (idle_id, "[GpkApplication] search");
@@ -1621,6 +2167,11 @@ gpk_application_remove_packages_cb (PkTask *task, GAsyncResult *res, GpkApplicat
 		return;
 	}
 
+	/* the cached info is now wrong */
+	gpk_package_cache_invalidate (priv->package_cache);
+	gpk_details_cache_invalidate (priv->details_cache);
+	gpk_scheduler_cancel (priv->scheduler, "prefetch");
+
 	/* idle add in the background */
 	idle_id = g_idle_add ((GSourceFunc) gpk_application_perform_search_idle_cb, priv);
 	g_source_set_name_by_id (idle_id, "[GpkApplication] search");
@@ -1632,20 +2183,47 @@ gpk_application_remove_packages_cb (PkTask *task, GAsyncResult *res, GpkApplicat
 }
 
 static void
-gpk_application_button_apply_cb (GtkWidget *widget, GpkApplicationPrivate *priv)
+gpk_application_install_packages_start (const gchar *key, GCancellable *cancellable,
+					GAsyncReadyCallback callback, gpointer callback_data,
+					GpkApplicationPrivate *priv)
 {
 	g_auto(GStrv) package_ids = NULL;
+
+	package_ids = pk_package_ids_from_string (key);
+	pk_task_install_packages_async (priv->task, package_ids, cancellable,
+					(PkProgressCallback) gpk_application_progress_cb, priv,
+					callback, callback_data);
+}
+
+static void
+gpk_application_remove_packages_start (const gchar *key, GCancellable *cancellable,
+				       GAsyncReadyCallback callback, gpointer callback_data,
+				       GpkApplicationPrivate *priv)
+{
 	gboolean autoremove;
+	g_auto(GStrv) package_ids = NULL;
+
+	autoremove = g_settings_get_boolean (priv->settings, GPK_SETTINGS_ENABLE_AUTOREMOVE);
+	package_ids = pk_package_ids_from_string (key);
+	pk_task_remove_packages_async (priv->task, package_ids, TRUE, autoremove, cancellable,
+				       (PkProgressCallback) gpk_application_progress_cb, priv,
+				       callback, callback_data);
+}
 
-	/* ensure new action succeeds */
-	g_cancellable_reset (priv->cancellable);
+static void
+gpk_application_button_apply_cb (GtkWidget *widget, GpkApplicationPrivate *priv)
+{
+	g_auto(GStrv) package_ids = NULL;
+	g_autofree gchar *key = NULL;
 
 	package_ids = pk_package_sack_get_ids (priv->package_sack);
+	key = pk_package_ids_to_string (package_ids);
 	if (priv->action == GPK_ACTION_INSTALL) {
 		/* install */
-		pk_task_install_packages_async (priv->task, package_ids, priv->cancellable,
-						(PkProgressCallback) gpk_application_progress_cb, priv,
-						(GAsyncReadyCallback) gpk_application_install_packages_cb, priv);
+		gpk_scheduler_add (priv->scheduler, GPK_SCHEDULER_PRIORITY_INTERACTIVE,
+				   "apply", key,
+				   (GpkSchedulerFunc) gpk_application_install_packages_start,
+				   (GAsyncReadyCallback) gpk_application_install_packages_cb, priv);
 
 		/* make package array insensitive */
 		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "treeview_packages"));
@@ -1658,12 +2236,11 @@ gpk_application_button_apply_cb (GtkWidget *widget, GpkApplicationPrivate *priv)
 		gtk_widget_set_visible (widget, FALSE);
 
 	} else if (priv->action == GPK_ACTION_REMOVE) {
-		autoremove = g_settings_get_boolean (priv->settings, GPK_SETTINGS_ENABLE_AUTOREMOVE);
-
 		/* remove */
-		pk_task_remove_packages_async (priv->task, package_ids, TRUE, autoremove, priv->cancellable,
-					       (PkProgressCallback) gpk_application_progress_cb, priv,
-					       (GAsyncReadyCallback) gpk_application_remove_packages_cb, priv);
+		gpk_scheduler_add (priv->scheduler, GPK_SCHEDULER_PRIORITY_INTERACTIVE,
+				   "apply", key,
+				   (GpkSchedulerFunc) gpk_application_remove_packages_start,
+				   (GAsyncReadyCallback) gpk_application_remove_packages_cb, priv);
 
 		/* make package array insensitive */
 		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "treeview_packages"));
@@ -1692,8 +2269,8 @@ gpk_application_packages_add_columns (GpkApplicationPrivate *priv)
 
 	/* TRANSLATORS: column for installed status */
 	column = gtk_tree_view_column_new_with_attributes (_("Installed"), renderer,
-							   "active", PACKAGES_COLUMN_CHECKBOX,
-							   "visible", PACKAGES_COLUMN_CHECKBOX_VISIBLE, NULL);
+							   "active", GPK_PACKAGE_LIST_COLUMN_CHECKBOX,
+							   "visible", GPK_PACKAGE_LIST_COLUMN_CHECKBOX_VISIBLE, NULL);
 	gtk_tree_view_append_column (treeview, column);
 
 	/* column for images */
@@ -1701,15 +2278,15 @@ gpk_application_packages_add_columns (GpkApplicationPrivate *priv)
 	renderer = gtk_cell_renderer_pixbuf_new ();
 	g_object_set (renderer, "stock-size", GTK_ICON_SIZE_DIALOG, NULL);
 	gtk_tree_view_column_pack_start (column, renderer, FALSE);
-	gtk_tree_view_column_add_attribute (column, renderer, "icon-name", PACKAGES_COLUMN_IMAGE);
+	gtk_tree_view_column_add_attribute (column, renderer, "icon-name", GPK_PACKAGE_LIST_COLUMN_IMAGE);
 	gtk_tree_view_append_column (treeview, column);
 
 	/* column for name */
 	renderer = gtk_cell_renderer_text_new ();
 	/* TRANSLATORS: column for package name */
 	column = gtk_tree_view_column_new_with_attributes (_("Name"), renderer,
-							   "markup", PACKAGES_COLUMN_TEXT, NULL);
-	gtk_tree_view_column_set_sort_column_id (column, PACKAGES_COLUMN_TEXT);
+							   "markup", GPK_PACKAGE_LIST_COLUMN_TEXT, NULL);
+	gtk_tree_view_column_set_sort_column_id (column, GPK_PACKAGE_LIST_COLUMN_TEXT);
 	gtk_tree_view_append_column (treeview, column);
 }
 
@@ -1787,19 +2364,13 @@ gpk_application_groups_treeview_changed_cb (GtkTreeSelection *selection, GpkAppl
 }
 
 static void
-gpk_application_get_details_cb (PkClient *client, GAsyncResult *res, GpkApplicationPrivate *priv)
+gpk_application_show_details (GpkApplicationPrivate *priv, PkDetails *item)
 {
-	g_autoptr(PkResults) results = NULL;
-	g_autoptr(GError) error = NULL;
-	g_autoptr(PkError) error_code = NULL;
-	g_autoptr(GPtrArray) array = NULL;
-	PkDetails *item;
 	GtkWidget *widget;
 	gchar *value;
 	const gchar *repo_name;
 	gboolean installed;
 	g_auto(GStrv) split = NULL;
-	GtkWindow *window;
 	g_autofree gchar *package_id = NULL;
 	g_autofree gchar *url = NULL;
 	PkGroupEnum group;
@@ -1807,37 +2378,6 @@ gpk_application_get_details_cb (PkClient *client, GAsyncResult *res, GpkApplicat
 	g_autofree gchar *description = NULL;
 	guint64 size;
 
-	/* get the results */
-	results = pk_client_generic_finish (client, res, &error);
-	if (results == NULL) {
-		g_warning ("failed to get list of categories: %s", error->message);
-		return;
-	}
-
-	/* check error code */
-	error_code = pk_results_get_error_code (results);
-	if (error_code != NULL) {
-		g_warning ("failed to get details: %s, %s", pk_error_enum_to_string (pk_error_get_code (error_code)), pk_error_get_details (error_code));
-
-		/* if obvious message, don't tell the user */
-		if (pk_error_get_code (error_code) != PK_ERROR_ENUM_TRANSACTION_CANCELLED) {
-			window = GTK_WINDOW (gtk_builder_get_object (priv->builder, "window_manager"));
-			gpk_error_dialog_modal (window, gpk_error_enum_to_localised_text (pk_error_get_code (error_code)),
-						gpk_error_enum_to_localised_message (pk_error_get_code (error_code)), pk_error_get_details (error_code));
-		}
-		return;
-	}
-
-	/* get data */
-	array = pk_results_get_details_array (results);
-	if (array->len != 1) {
-		g_warning ("not one entry %i", array->len);
-		return;
-	}
-
-	/* only choose the first item */
-	item = g_ptr_array_index (array, 0);
-
 	/* show to start */
 	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "grid_details"));
 	gtk_widget_show (widget);
@@ -1914,6 +2454,198 @@ gpk_application_get_details_cb (PkClient *client, GAsyncResult *res, GpkApplicat
 	gtk_label_set_label (GTK_LABEL (widget), repo_name);
 }
 
+static void
+gpk_application_get_details_cb (PkClient *client, GAsyncResult *res, GpkApplicationPrivate *priv)
+{
+	g_autoptr(PkResults) results = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(PkError) error_code = NULL;
+	g_autoptr(GPtrArray) array = NULL;
+	PkDetails *item;
+	GtkWindow *window;
+
+	/* get the results */
+	results = pk_client_generic_finish (client, res, &error);
+	if (results == NULL) {
+		if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+			g_warning ("failed to get details: %s", error->message);
+		return;
+	}
+
+	/* check error code */
+	error_code = pk_results_get_error_code (results);
+	if (error_code != NULL) {
+		g_warning ("failed to get details: %s, %s", pk_error_enum_to_string (pk_error_get_code (error_code)), pk_error_get_details (error_code));
+
+		/* if obvious message, don't tell the user */
+		if (pk_error_get_code (error_code) != PK_ERROR_ENUM_TRANSACTION_CANCELLED) {
+			window = GTK_WINDOW (gtk_builder_get_object (priv->builder, "window_manager"));
+			gpk_error_dialog_modal (window, gpk_error_enum_to_localised_text (pk_error_get_code (error_code)),
+						gpk_error_enum_to_localised_message (pk_error_get_code (error_code)), pk_error_get_details (error_code));
+		}
+		return;
+	}
+
+	/* get data */
+	array = pk_results_get_details_array (results);
+	if (array->len != 1) {
+		g_warning ("not one entry %i", array->len);
+		return;
+	}
+
+	/* only choose the first item */
+	item = g_ptr_array_index (array, 0);
+	gpk_details_cache_add (priv->details_cache, item);
+
+	/* the user has already selected something else */
+	if (g_strcmp0 (pk_details_get_package_id (item), priv->details_package_id) != 0) {
+		g_debug ("ignoring details for %s", pk_details_get_package_id (item));
+		return;
+	}
+
+	gpk_application_show_details (priv, item);
+}
+
+static void
+gpk_application_prefetch_cb (PkClient *client, GAsyncResult *res, GpkApplicationPrivate *priv)
+{
+	PkDetails *item;
+	guint i;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) array = NULL;
+	g_autoptr(PkError) error_code = NULL;
+	g_autoptr(PkResults) results = NULL;
+
+	/* get the results */
+	results = pk_client_generic_finish (client, res, &error);
+	if (results == NULL) {
+		g_debug ("failed to prefetch details: %s", error->message);
+		return;
+	}
+	error_code = pk_results_get_error_code (results);
+	if (error_code != NULL) {
+		g_debug ("failed to prefetch details: %s", pk_error_get_details (error_code));
+		return;
+	}
+
+	/* ready for when the user gets there */
+	array = pk_results_get_details_array (results);
+	for (i = 0; i < array->len; i++) {
+		item = g_ptr_array_index (array, i);
+		gpk_details_cache_add (priv->details_cache, item);
+	}
+	g_debug ("prefetched details for %u packages", array->len);
+}
+
+static void
+gpk_application_prefetch_start (const gchar *key, GCancellable *cancellable,
+				GAsyncReadyCallback callback, gpointer callback_data,
+				GpkApplicationPrivate *priv)
+{
+	g_auto(GStrv) package_ids = NULL;
+
+	/* marked as background so the daemon does it after anything else */
+	package_ids = pk_package_ids_from_string (key);
+	g_debug ("prefetching details for %u packages", g_strv_length (package_ids));
+	pk_client_get_details_async (priv->prefetch_client, package_ids, cancellable,
+				     NULL, NULL,
+				     callback, callback_data);
+}
+
+static gboolean
+gpk_application_prefetch_timeout_cb (GpkApplicationPrivate *priv)
+{
+	GtkTreeIter iter;
+	GtkTreeModel *model;
+	GtkTreePath *path = NULL;
+	GtkTreePath *path_end = NULL;
+	GtkTreeView *treeview;
+	gint cursor = 0;
+	gint end;
+	gint i;
+	gint start;
+	g_autofree gchar *key = NULL;
+	g_autoptr(GPtrArray) package_ids = NULL;
+
+	priv->prefetch_id = 0;
+
+	/* the list is still being filled in */
+	treeview = GTK_TREE_VIEW (gtk_builder_get_object (priv->builder, "treeview_packages"));
+	model = gtk_tree_view_get_model (treeview);
+	if (model == NULL || !priv->has_package)
+		return FALSE;
+
+	/* the rows either side of the cursor */
+	gtk_tree_view_get_cursor (treeview, &path, NULL);
+	if (path != NULL) {
+		cursor = gtk_tree_path_get_indices (path)[0];
+		gtk_tree_path_free (path);
+	}
+	start = MAX (cursor - GPK_APPLICATION_PREFETCH_ROWS, 0);
+	end = cursor + GPK_APPLICATION_PREFETCH_ROWS;
+
+	/* and everything the user can see */
+	if (gtk_tree_view_get_visible_range (treeview, &path, &path_end)) {
+		start = MIN (start, gtk_tree_path_get_indices (path)[0]);
+		end = MAX (end, gtk_tree_path_get_indices (path_end)[0]);
+		gtk_tree_path_free (path);
+		gtk_tree_path_free (path_end);
+	}
+
+	/* only ask for what we don't already have */
+	package_ids = g_ptr_array_new_with_free_func (g_free);
+	if (!gtk_tree_model_iter_nth_child (model, &iter, NULL, start))
+		return FALSE;
+	for (i = start; i <= end && package_ids->len < GPK_APPLICATION_PREFETCH_MAX; i++) {
+		g_autofree gchar *package_id = NULL;
+		gtk_tree_model_get (model, &iter,
+				    GPK_PACKAGE_LIST_COLUMN_ID, &package_id,
+				    -1);
+		if (package_id != NULL &&
+		    g_strcmp0 (package_id, priv->details_package_id) != 0 &&
+		    !gpk_details_cache_contains (priv->details_cache, package_id))
+			g_ptr_array_add (package_ids, g_steal_pointer (&package_id));
+		if (!gtk_tree_model_iter_next (model, &iter))
+			break;
+	}
+	if (package_ids->len == 0)
+		return FALSE;
+	g_ptr_array_add (package_ids, NULL);
+
+	/* all in one transaction, which replaces any for the old position */
+	key = pk_package_ids_to_string ((gchar **) package_ids->pdata);
+	gpk_scheduler_add (priv->scheduler, GPK_SCHEDULER_PRIORITY_PREFETCH,
+			   "prefetch", key,
+			   (GpkSchedulerFunc) gpk_application_prefetch_start,
+			   (GAsyncReadyCallback) gpk_application_prefetch_cb, priv);
+	return FALSE;
+}
+
+static void
+gpk_application_prefetch_schedule (GpkApplicationPrivate *priv)
+{
+	if (priv->prefetch_id > 0)
+		g_source_remove (priv->prefetch_id);
+	priv->prefetch_id = g_timeout_add_full (G_PRIORITY_LOW,
+						GPK_APPLICATION_PREFETCH_DELAY,
+						(GSourceFunc) gpk_application_prefetch_timeout_cb,
+						priv, NULL);
+	g_source_set_name_by_id (priv->prefetch_id, "[GpkApplication] prefetch");
+}
+
+static void
+gpk_application_get_details_start (const gchar *package_id, GCancellable *cancellable,
+				   GAsyncReadyCallback callback, gpointer callback_data,
+				   GpkApplicationPrivate *priv)
+{
+	g_auto(GStrv) package_ids = NULL;
+
+	package_ids = pk_package_ids_from_id (package_id);
+	pk_client_get_details_async (PK_CLIENT(priv->task), package_ids, cancellable,
+				     (PkProgressCallback) gpk_application_progress_cb, priv,
+				     callback, callback_data);
+}
+
 static void
 gpk_application_packages_treeview_clicked_cb (GtkTreeSelection *selection, GpkApplicationPrivate *priv)
 {
@@ -1923,7 +2655,7 @@ gpk_application_packages_treeview_clicked_cb (GtkTreeSelection *selection, GpkAp
 	gboolean show_install = TRUE;
 	gboolean show_remove = TRUE;
 	PkBitfield state;
-	g_auto(GStrv) package_ids = NULL;
+	PkDetails *details;
 	g_autofree gchar *package_id = NULL;
 	g_autofree gchar *summary = NULL;
 
@@ -1948,9 +2680,9 @@ gpk_application_packages_treeview_clicked_cb (GtkTreeSelection *selection, GpkAp
 
 	/* check we aren't a help line */
 	gtk_tree_model_get (model, &iter,
-			    PACKAGES_COLUMN_STATE, &state,
-			    PACKAGES_COLUMN_ID, &package_id,
-			    PACKAGES_COLUMN_SUMMARY, &summary,
+			    GPK_PACKAGE_LIST_COLUMN_STATE, &state,
+			    GPK_PACKAGE_LIST_COLUMN_ID, &package_id,
+			    GPK_PACKAGE_LIST_COLUMN_SUMMARY, &summary,
 			    -1);
 	if (package_id == NULL) {
 		g_debug ("ignoring help click");
@@ -1975,18 +2707,38 @@ gpk_application_packages_treeview_clicked_cb (GtkTreeSelection *selection, GpkAp
 	gpk_application_allow_install (priv, show_install);
 	gpk_application_allow_remove (priv, show_remove);
 
+	/* we've seen this one before */
+	g_free (priv->details_package_id);
+	priv->details_package_id = g_strdup (package_id);
+	gpk_application_prefetch_schedule (priv);
+	details = gpk_details_cache_lookup (priv->details_cache, package_id);
+	if (details != NULL) {
+		gpk_application_show_details (priv, details);
+		return;
+	}
+
 	/* clear the description text */
 	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "textview_description"));
 	gpk_application_set_text_buffer (widget, NULL);
 
-	/* ensure new action succeeds */
-	g_cancellable_reset (priv->cancellable);
+	/* get the details, which replaces any for the old selection */
+	gpk_scheduler_add (priv->scheduler, GPK_SCHEDULER_PRIORITY_INTERACTIVE,
+			   "get-details", package_id,
+			   (GpkSchedulerFunc) gpk_application_get_details_start,
+			   (GAsyncReadyCallback) gpk_application_get_details_cb, priv);
+}
 
-	/* get the details */
-	package_ids = pk_package_ids_from_id (package_id);
-	pk_client_get_details_async (PK_CLIENT(priv->task), package_ids, priv->cancellable,
-				     (PkProgressCallback) gpk_application_progress_cb, priv,
-				     (GAsyncReadyCallback) gpk_application_get_details_cb, priv);
+static void
+gpk_application_cache_invalidate_cb (PkControl *control, GpkApplicationPrivate *priv)
+{
+	g_debug ("package cache is out of date");
+	gpk_package_cache_invalidate (priv->package_cache);
+	gpk_details_cache_invalidate (priv->details_cache);
+	gpk_scheduler_cancel (priv->scheduler, "prefetch");
+
+	/* get the new list in the background */
+	if (pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_GET_PACKAGES))
+		gpk_application_cache_refresh (priv, GPK_MODE_ALL_PACKAGES, 0);
 }
 
 static void
@@ -2266,6 +3018,16 @@ gpk_application_refresh_cache_cb (PkClient *client, GAsyncResult *res, GpkApplic
 	}
 }
 
+static void
+gpk_application_refresh_cache_start (const gchar *key, GCancellable *cancellable,
+				     GAsyncReadyCallback callback, gpointer callback_data,
+				     GpkApplicationPrivate *priv)
+{
+	pk_task_refresh_cache_async (priv->task, TRUE, cancellable,
+				     (PkProgressCallback) gpk_application_progress_cb, priv,
+				     callback, callback_data);
+}
+
 static void
 gpk_application_activate_refresh_cb (GSimpleAction *action,
 				     GVariant *parameter,
@@ -2273,12 +3035,10 @@ gpk_application_activate_refresh_cb (GSimpleAction *action,
 {
 	GpkApplicationPrivate *priv = user_data;
 
-	/* ensure new action succeeds */
-	g_cancellable_reset (priv->cancellable);
-
-	pk_task_refresh_cache_async (priv->task, TRUE, priv->cancellable,
-				     (PkProgressCallback) gpk_application_progress_cb, priv,
-				     (GAsyncReadyCallback) gpk_application_refresh_cache_cb, priv);
+	gpk_scheduler_add (priv->scheduler, GPK_SCHEDULER_PRIORITY_INTERACTIVE,
+			   "refresh-cache", NULL,
+			   (GpkSchedulerFunc) gpk_application_refresh_cache_start,
+			   (GAsyncReadyCallback) gpk_application_refresh_cache_cb, priv);
 }
 
 static void
@@ -2301,8 +3061,8 @@ gpk_application_package_row_activated_cb (GtkTreeView *treeview, GtkTreePath *pa
 
 	/* get data */
 	gtk_tree_model_get (model, &iter,
-			    PACKAGES_COLUMN_STATE, &state,
-			    PACKAGES_COLUMN_ID, &package_id,
+			    GPK_PACKAGE_LIST_COLUMN_STATE, &state,
+			    GPK_PACKAGE_LIST_COLUMN_ID, &package_id,
 			    -1);
 
 	/* check we aren't a help line */
@@ -2328,13 +3088,10 @@ gpk_application_group_row_separator_func (GtkTreeModel *model, GtkTreeIter *iter
 static void
 gpk_application_add_welcome (GpkApplicationPrivate *priv)
 {
-	GtkTreeIter iter;
 	const gchar *welcome;
-	PkBitfield state = 0;
 
 	g_debug ("CLEAR welcome");
 	gpk_application_clear_packages (priv);
-	gtk_list_store_append (priv->packages_store, &iter);
 
 	/* enter something nice */
 	if (pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_SEARCH_GROUP)) {
@@ -2344,15 +3101,8 @@ gpk_application_add_welcome (GpkApplicationPrivate *priv)
 		/* TRANSLATORS: welcome text if we have to search by name */
 		welcome = _("Enter a search word to get started.");
 	}
-	gtk_list_store_set (priv->packages_store, &iter,
-			    PACKAGES_COLUMN_STATE, state,
-			    PACKAGES_COLUMN_CHECKBOX, FALSE,
-			    PACKAGES_COLUMN_CHECKBOX_VISIBLE, FALSE,
-			    PACKAGES_COLUMN_TEXT, welcome,
-			    PACKAGES_COLUMN_IMAGE, "system-search",
-			    PACKAGES_COLUMN_SUMMARY, NULL,
-			    PACKAGES_COLUMN_ID, NULL,
-			    -1);
+	gpk_package_list_model_append_message (priv->packages_store, NULL,
+					       "system-search", welcome);
 }
 
 static void
@@ -2377,6 +3127,29 @@ gpk_application_create_group_array_enum (GpkApplicationPrivate *priv)
 	}
 }
 
+static void
+gpk_application_categories_add_node (GpkApplicationPrivate *priv,
+				     GNode *node,
+				     GtkTreeIter *parent)
+{
+	GNode *child;
+	GtkTreeIter iter;
+	PkCategory *item;
+
+	/* prepend in reverse, as appending has to find the last sibling */
+	for (child = g_node_last_child (node); child != NULL; child = child->prev) {
+		item = child->data;
+		gtk_tree_store_insert_with_values (priv->groups_store, &iter, parent, 0,
+						   GROUPS_COLUMN_NAME, pk_category_get_name (item),
+						   GROUPS_COLUMN_SUMMARY, pk_category_get_summary (item),
+						   GROUPS_COLUMN_ID, pk_category_get_id (item),
+						   GROUPS_COLUMN_ICON, pk_category_get_icon (item),
+						   GROUPS_COLUMN_ACTIVE, parent != NULL,
+						   -1);
+		gpk_application_categories_add_node (priv, child, &iter);
+	}
+}
+
 static void
 gpk_application_get_categories_cb (PkClient *client, GAsyncResult *res, GpkApplicationPrivate *priv)
 {
@@ -2384,12 +3157,8 @@ gpk_application_get_categories_cb (PkClient *client, GAsyncResult *res, GpkAppli
 	g_autoptr(GError) error = NULL;
 	g_autoptr(PkError) error_code = NULL;
 	g_autoptr(GPtrArray) array = NULL;
-	GtkTreeIter iter;
-	GtkTreeIter iter2;
-	guint i, j;
+	GNode *tree;
 	GtkTreeView *treeview;
-	PkCategory *item;
-	PkCategory *item2;
 	GtkWindow *window;
 
 	/* get the results */
@@ -2418,77 +3187,34 @@ gpk_application_get_categories_cb (PkClient *client, GAsyncResult *res, GpkAppli
 	gtk_tree_view_set_show_expanders (treeview, TRUE);
 	gtk_tree_view_set_level_indentation  (treeview, 3);
 
-	/* add repos with descriptions */
+	/* add the categories in one pass, however deep */
 	array = pk_results_get_category_array (results);
-	for (i = 0; i < array->len; i++) {
-		g_autofree gchar *package_id = NULL;
-		g_autofree gchar *name = NULL;
-		g_autofree gchar *summary = NULL;
-		g_autofree gchar *cat_id = NULL;
-		g_autofree gchar *icon = NULL;
-
-		item = g_ptr_array_index (array, i);
-		g_object_get (item,
-			      "name", &name,
-			      "summary", &summary,
-			      "cat-id", &cat_id,
-			      "icon", &icon,
-			      NULL);
-
-		gtk_tree_store_append (priv->groups_store, &iter, NULL);
-		gtk_tree_store_set (priv->groups_store, &iter,
-				    GROUPS_COLUMN_NAME, name,
-				    GROUPS_COLUMN_SUMMARY, summary,
-				    GROUPS_COLUMN_ID, cat_id,
-				    GROUPS_COLUMN_ICON, icon,
-				    GROUPS_COLUMN_ACTIVE, FALSE,
-				    -1);
-		j = 0;
-		do {
-			g_autofree gchar *cat_id_tmp = NULL;
-			g_autofree gchar *icon_tmp = NULL;
-			g_autofree gchar *name_tmp = NULL;
-			g_autofree gchar *parent_id_tmp = NULL;
-			g_autofree gchar *summary_tmp = NULL;
-
-			/* only allows groups two layers deep */
-			item2 = g_ptr_array_index (array, j);
-			g_object_get (item2,
-				      "parent-id", &parent_id_tmp,
-				      "cat-id", &cat_id_tmp,
-				      "name", &name_tmp,
-				      "summary", &summary_tmp,
-				      "icon", &icon_tmp,
-				      NULL);
-			if (g_strcmp0 (parent_id_tmp, cat_id) == 0) {
-				gtk_tree_store_append (priv->groups_store, &iter2, &iter);
-				gtk_tree_store_set (priv->groups_store, &iter2,
-						    GROUPS_COLUMN_NAME, name_tmp,
-						    GROUPS_COLUMN_SUMMARY, summary_tmp,
-						    GROUPS_COLUMN_ID, cat_id_tmp,
-						    GROUPS_COLUMN_ICON, icon_tmp,
-						    GROUPS_COLUMN_ACTIVE, TRUE,
-						    -1);
-				g_ptr_array_remove (array, item2);
-			} else
-				j++;
-		} while (j < array->len);
-	}
+	tree = gpk_category_array_to_tree (array);
+	gpk_application_categories_add_node (priv, tree, NULL);
+	g_node_destroy (tree);
 
 	/* open all expanders */
 	gtk_tree_view_collapse_all (treeview);
 }
 
 static void
-gpk_application_create_group_array_categories (GpkApplicationPrivate *priv)
+gpk_application_get_categories_start (const gchar *key, GCancellable *cancellable,
+				      GAsyncReadyCallback callback, gpointer callback_data,
+				      GpkApplicationPrivate *priv)
 {
-	/* ensure new action succeeds */
-	g_cancellable_reset (priv->cancellable);
+	pk_client_get_categories_async (PK_CLIENT(priv->task), cancellable,
+				        (PkProgressCallback) gpk_application_progress_cb, priv,
+				        callback, callback_data);
+}
 
+static void
+gpk_application_create_group_array_categories (GpkApplicationPrivate *priv)
+{
 	/* get categories supported */
-	pk_client_get_categories_async (PK_CLIENT(priv->task), priv->cancellable,
-				        (PkProgressCallback) gpk_application_progress_cb, priv,
-				        (GAsyncReadyCallback) gpk_application_get_categories_cb, priv);
+	gpk_scheduler_add (priv->scheduler, GPK_SCHEDULER_PRIORITY_INTERACTIVE,
+			   "get-categories", NULL,
+			   (GpkSchedulerFunc) gpk_application_get_categories_start,
+			   (GAsyncReadyCallback) gpk_application_get_categories_cb, priv);
 }
 
 static void
@@ -2640,6 +3366,11 @@ pk_backend_status_get_properties_cb (GObject *object, GAsyncResult *res, GpkAppl
 
 	/* welcome */
 	gpk_application_add_welcome (priv);
+
+	/* get every package in the background so names can be searched locally */
+	if (pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_GET_PACKAGES) &&
+	    !gpk_package_cache_has_packages (priv->package_cache, priv->filters_current, NULL))
+		gpk_application_cache_refresh (priv, GPK_MODE_ALL_PACKAGES, 0);
 }
 
 static void
@@ -2688,10 +3419,24 @@ gpk_application_get_repo_list_cb (PkClient *client, GAsyncResult *res, GpkApplic
 		g_debug ("repo = %s:%s", repo_id, description);
 		/* no problem, just no point adding as we will fallback to the repo_id */
 		if (description != NULL)
-			g_hash_table_insert (priv->repos, g_strdup (repo_id), g_strdup (description));
+			g_hash_table_insert (priv->repos,
+					     (gpointer) gpk_string_pool_intern (gpk_string_pool_get_default (), repo_id),
+					     g_strdup (description));
 	}
 }
 
+static void
+gpk_application_get_repo_list_start (const gchar *key, GCancellable *cancellable,
+				     GAsyncReadyCallback callback, gpointer callback_data,
+				     GpkApplicationPrivate *priv)
+{
+	pk_client_get_repo_list_async (PK_CLIENT (priv->task),
+				       pk_bitfield_value (PK_FILTER_ENUM_NONE),
+				       cancellable,
+				       (PkProgressCallback) gpk_application_progress_cb, priv,
+				       callback, callback_data);
+}
+
 static void
 gpk_application_activate_cb (GtkApplication *_application, GpkApplicationPrivate *priv)
 {
@@ -2710,24 +3455,31 @@ gpk_application_startup_cb (GtkApplication *application, GpkApplicationPrivate *
 	GtkWidget *main_window;
 	GtkWidget *widget;
 	guint retval;
+	g_autofree gchar *cache_filename = NULL;
+	g_autoptr(GError) error_cache = NULL;
 
 	priv->package_sack = pk_package_sack_new ();
 	priv->settings = g_settings_new (GPK_SETTINGS_SCHEMA);
-	priv->cancellable = g_cancellable_new ();
-	priv->repos = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	priv->scheduler = gpk_scheduler_new ();
+	priv->repos = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+	priv->packages_seen = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	priv->load_queue = g_queue_new ();
+	priv->details_cache = gpk_details_cache_new (GPK_APPLICATION_DETAILS_CACHE_SIZE);
+
+	/* show what we knew last time until PackageKit has answered */
+	cache_filename = g_build_filename (g_get_user_cache_dir (),
+					   "gnome-packagekit",
+					   "packages.cache",
+					   NULL);
+	priv->package_cache = gpk_package_cache_new (cache_filename);
+	if (!gpk_package_cache_load (priv->package_cache, &error_cache))
+		g_debug ("no package cache: %s", error_cache->message);
 
 	/* watch gnome-packagekit keys */
 	g_signal_connect (priv->settings, "changed", G_CALLBACK (gpk_application_key_changed_cb), priv);
 
 	/* create array stores */
-	priv->packages_store = gtk_list_store_new (PACKAGES_COLUMN_LAST,
-					      G_TYPE_STRING,
-					      G_TYPE_UINT64,
-					      G_TYPE_BOOLEAN,
-					      G_TYPE_BOOLEAN,
-					      G_TYPE_STRING,
-					      G_TYPE_STRING,
-					      G_TYPE_STRING);
+	priv->packages_store = gpk_package_list_model_new ();
 	priv->groups_store = gtk_tree_store_new (GROUPS_COLUMN_LAST,
 					   G_TYPE_STRING,
 					   G_TYPE_STRING,
@@ -2749,10 +3501,21 @@ gpk_application_startup_cb (GtkApplication *application, GpkApplicationPrivate *
 		      "background", FALSE,
 		      NULL);
 
+	/* details for rows the user has not got to yet */
+	priv->prefetch_client = pk_client_new ();
+	g_object_set (priv->prefetch_client,
+		      "background", TRUE,
+		      "interactive", FALSE,
+		      NULL);
+
 	/* get properties */
 	pk_control_get_properties_async (priv->control, NULL, (GAsyncReadyCallback) pk_backend_status_get_properties_cb, priv);
 	g_signal_connect (priv->control, "notify::network-state",
 			  G_CALLBACK (gpk_application_notify_network_state_cb), priv);
+	g_signal_connect (priv->control, "updates-changed",
+			  G_CALLBACK (gpk_application_cache_invalidate_cb), priv);
+	g_signal_connect (priv->control, "repo-list-changed",
+			  G_CALLBACK (gpk_application_cache_invalidate_cb), priv);
 
 	/* get UI */
 	priv->builder = gtk_builder_new ();
@@ -2843,9 +3606,6 @@ gpk_application_startup_cb (GtkApplication *application, GpkApplicationPrivate *
 	g_signal_connect (GTK_EDITABLE (widget), "changed",
 			  G_CALLBACK (gpk_application_text_changed_cb), priv);
 
-	/* mark find button insensitive */
-	gpk_application_set_button_find_sensitivity (priv);
-
 	/* set a size, as much as the screen allows */
 	gtk_window_set_default_size (GTK_WINDOW (main_window), 1000, 600);
 	gtk_widget_show (GTK_WIDGET(main_window));
@@ -2857,7 +3617,11 @@ gpk_application_startup_cb (GtkApplication *application, GpkApplicationPrivate *
 
 	/* sorted */
 	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (priv->packages_store),
-					      PACKAGES_COLUMN_ID, GTK_SORT_ASCENDING);
+					      GPK_PACKAGE_LIST_COLUMN_ID, GTK_SORT_ASCENDING);
+
+	/* used for the second line of each row */
+	gpk_package_list_model_set_style_context (priv->packages_store,
+						  gtk_widget_get_style_context (main_window));
 
 	/* create package tree view */
 	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "treeview_packages"));
@@ -2887,11 +3651,10 @@ gpk_application_startup_cb (GtkApplication *application, GpkApplicationPrivate *
 			  G_CALLBACK (gpk_application_groups_treeview_changed_cb), priv);
 
 	/* get repos, so we can show the full name in the package source box */
-	pk_client_get_repo_list_async (PK_CLIENT (priv->task),
-				       pk_bitfield_value (PK_FILTER_ENUM_NONE),
-				       priv->cancellable,
-				       (PkProgressCallback) gpk_application_progress_cb, priv,
-				       (GAsyncReadyCallback) gpk_application_get_repo_list_cb, priv);
+	gpk_scheduler_add (priv->scheduler, GPK_SCHEDULER_PRIORITY_INTERACTIVE,
+			   "get-repo-list", NULL,
+			   (GpkSchedulerFunc) gpk_application_get_repo_list_start,
+			   (GAsyncReadyCallback) gpk_application_get_repo_list_cb, priv);
 
 	/* set current action */
 	priv->action = GPK_ACTION_NONE;
@@ -2948,6 +3711,7 @@ main (int argc, char *argv[])
 	gboolean ret;
 	gint status = 0;
 	g_autofree gchar *filename = NULL;
+	g_autoptr(GError) error = NULL;
 	GpkApplicationPrivate *priv;
 
 	const GOptionEntry options[] = {
@@ -3011,9 +3775,35 @@ main (int argc, char *argv[])
 
 	if (priv->details_event_id > 0)
 		g_source_remove (priv->details_event_id);
+	if (priv->prefetch_id > 0)
+		g_source_remove (priv->prefetch_id);
 
 	if (priv->packages_store != NULL)
 		g_object_unref (priv->packages_store);
+	if (priv->details_cache != NULL) {
+		gpk_debug_stats ("details",
+				 gpk_details_cache_get_hits (priv->details_cache),
+				 gpk_details_cache_get_misses (priv->details_cache));
+		g_object_unref (priv->details_cache);
+	}
+	if (priv->package_cache != NULL) {
+		if (gpk_package_cache_get_dirty (priv->package_cache) &&
+		    !gpk_package_cache_save (priv->package_cache, &error))
+			g_warning ("failed to save package cache: %s", error->message);
+		g_object_unref (priv->package_cache);
+	}
+	gpk_debug_memory ("string",
+			  gpk_string_pool_get_size (gpk_string_pool_get_default ()),
+			  gpk_string_pool_get_saved (gpk_string_pool_get_default ()));
+	if (priv->scheduler != NULL) {
+		gpk_debug_stats ("request",
+				 gpk_scheduler_get_coalesced (priv->scheduler),
+				 gpk_scheduler_get_started (priv->scheduler));
+		gpk_scheduler_cancel_all (priv->scheduler);
+		g_object_unref (priv->scheduler);
+	}
+	if (priv->prefetch_client != NULL)
+		g_object_unref (priv->prefetch_client);
 	if (priv->control != NULL)
 		g_object_unref (priv->control);
 	if (priv->task != NULL)
@@ -3022,14 +3812,21 @@ main (int argc, char *argv[])
 		g_object_unref (priv->settings);
 	if (priv->builder != NULL)
 		g_object_unref (priv->builder);
-	if (priv->cancellable != NULL)
-		g_object_unref (priv->cancellable);
 	if (priv->package_sack != NULL)
 		g_object_unref (priv->package_sack);
 	if (priv->repos != NULL)
 		g_hash_table_destroy (priv->repos);
+	if (priv->packages_seen != NULL)
+		g_hash_table_destroy (priv->packages_seen);
+	if (priv->load_id > 0)
+		g_source_remove (priv->load_id);
+	if (priv->load_queue != NULL)
+		g_queue_free_full (priv->load_queue, (GDestroyNotify) g_object_unref);
 	if (priv->status_id > 0)
 		g_source_remove (priv->status_id);
+	if (priv->search_timeout_id > 0)
+		g_source_remove (priv->search_timeout_id);
+	g_free (priv->details_package_id);
 	g_free (priv->homepage_url);
 	g_free (priv->search_group);
 	g_free (priv->search_text);
@@ -133,22 +133,22 @@ gpk_window_set_parent_xid (GtkWindow *window, guint32 xid)
 }
 
 static const gchar *
-gpk_get_pretty_arch (const gchar *arch)
+gpk_get_pretty_arch (const gchar *arch, guint len)
 {
 	const gchar *id = NULL;
 
-	if (arch[0] == '\0')
+	if (len == 0)
 		goto out;
 
 	/* 32 bit */
-	if (g_str_has_prefix (arch, "i")) {
+	if (arch[0] == 'i') {
 		/* TRANSLATORS: a 32 bit package */
 		id = _("32-bit");
 		goto out;
 	}
 
 	/* 64 bit */
-	if (g_str_has_suffix (arch, "64")) {
+	if (len >= 2 && arch[len - 2] == '6' && arch[len - 1] == '4') {
 		/* TRANSLATORS: a 64 bit package */
 		id = _("64-bit");
 		goto out;
@@ -157,81 +157,207 @@ out:
 	return id;
 }
 
+/**
+ * gpk_package_id_view_parse:
+ * @view: the #GpkPackageIdView to fill in
+ * @package_id: a package ID, which must outlive @view
+ *
+ * Finds the fields of a package ID without copying them, which is much
+ * cheaper than pk_package_id_split() when only one or two are needed.
+ *
+ * Return value: %FALSE if @package_id is not valid
+ **/
+gboolean
+gpk_package_id_view_parse (GpkPackageIdView *view, const gchar *package_id)
+{
+	const gchar *tmp;
+	guint field = 0;
+	guint start = 0;
+	guint i;
+
+	g_return_val_if_fail (view != NULL, FALSE);
+
+	if (package_id == NULL)
+		return FALSE;
+	view->package_id = package_id;
+	for (tmp = package_id; ; tmp++) {
+		if (*tmp != ';' && *tmp != '\0')
+			continue;
+		i = tmp - package_id;
+		if (field > PK_PACKAGE_ID_DATA)
+			return FALSE;
+		view->offset[field] = start;
+		view->len[field] = i - start;
+		field++;
+		start = i + 1;
+		if (*tmp == '\0')
+			break;
+	}
+
+	/* the same checks as pk_package_id_check() */
+	if (field != PK_PACKAGE_ID_DATA + 1)
+		return FALSE;
+	return view->len[PK_PACKAGE_ID_NAME] > 0;
+}
+
+/**
+ * gpk_package_id_view_get:
+ * @field: e.g. %PK_PACKAGE_ID_NAME
+ * @len: (out): the length of the field
+ *
+ * Return value: the start of the field, which is not NUL terminated
+ **/
+const gchar *
+gpk_package_id_view_get (const GpkPackageIdView *view, guint field, guint *len)
+{
+	*len = view->len[field];
+	return view->package_id + view->offset[field];
+}
+
+/**
+ * gpk_package_id_view_dup:
+ **/
 gchar *
-gpk_package_id_format_twoline (GtkStyleContext *style,
-			       const gchar *package_id,
-			       const gchar *summary)
+gpk_package_id_view_dup (const GpkPackageIdView *view, guint field)
+{
+	return g_strndup (view->package_id + view->offset[field], view->len[field]);
+}
+
+/**
+ * gpk_package_id_view_equal:
+ *
+ * Return value: %TRUE if the field is exactly @str
+ **/
+gboolean
+gpk_package_id_view_equal (const GpkPackageIdView *view, guint field, const gchar *str)
+{
+	if (str == NULL)
+		return FALSE;
+	return strncmp (view->package_id + view->offset[field], str, view->len[field]) == 0 &&
+	       str[view->len[field]] == '\0';
+}
+
+/**
+ * gpk_package_id_view_contains:
+ *
+ * Return value: %TRUE if @needle is found in the field
+ **/
+gboolean
+gpk_package_id_view_contains (const GpkPackageIdView *view, guint field, const gchar *needle)
+{
+	return g_strstr_len (view->package_id + view->offset[field],
+			     view->len[field], needle) != NULL;
+}
+
+/**
+ * gpk_style_context_get_inactive_color:
+ *
+ * Return value: the color used for the second line of the markup
+ **/
+gchar *
+gpk_style_context_get_inactive_color (GtkStyleContext *style)
+{
+	GdkRGBA inactive;
+
+	if (style == NULL)
+		return g_strdup ("gray");
+	gtk_style_context_get_color (style,
+				     GTK_STATE_FLAG_INSENSITIVE,
+				     &inactive);
+	return g_strdup_printf ("#%02x%02x%02x",
+				(guint) (inactive.red * 255.0f),
+				(guint) (inactive.green * 255.0f),
+				(guint) (inactive.blue * 255.0f));
+}
+
+/**
+ * gpk_package_id_format_twoline_color:
+ * @color: a color from gpk_style_context_get_inactive_color()
+ *
+ * This does not use GTK, so can be called from any thread.
+ **/
+gchar *
+gpk_package_id_format_twoline_color (const gchar *color,
+				     const gchar *package_id,
+				     const gchar *summary)
 {
 	g_autofree gchar *summary_safe = NULL;
 	GString *string;
-	g_auto(GStrv) split = NULL;
-	g_autofree gchar *color = NULL;
+	GpkPackageIdView view;
 	const gchar *arch;
-	GdkRGBA inactive;
+	const gchar *tmp;
+	guint len;
 
+	g_return_val_if_fail (color != NULL, NULL);
 	g_return_val_if_fail (package_id != NULL, NULL);
 
-	/* get style color */
-	if (style != NULL) {
-		gtk_style_context_get_color (style,
-					     GTK_STATE_FLAG_INSENSITIVE,
-					     &inactive);
-		color = g_strdup_printf ("#%02x%02x%02x",
-					 (guint) (inactive.red * 255.0f),
-					 (guint) (inactive.green * 255.0f),
-					 (guint) (inactive.blue * 255.0f));
-	} else {
-		color = g_strdup ("gray");
-	}
-
 	/* optional */
-	split = pk_package_id_split (package_id);
-	if (split == NULL) {
+	if (!gpk_package_id_view_parse (&view, package_id)) {
 		g_warning ("could not parse %s", package_id);
 		return NULL;
 	}
 
-	/* no summary */
-	if (summary == NULL || summary[0] == '\0') {
-		string = g_string_new (split[PK_PACKAGE_ID_NAME]);
-		if (split[PK_PACKAGE_ID_VERSION][0] != '\0')
-			g_string_append_printf (string, "-%s", split[PK_PACKAGE_ID_VERSION]);
-		arch = gpk_get_pretty_arch (split[PK_PACKAGE_ID_ARCH]);
-		if (arch != NULL)
-			g_string_append_printf (string, " (%s)", arch);
-		return g_string_free (string, FALSE);
-	}
-
 	/* name and summary */
-	string = g_string_new ("");
-	summary_safe = g_markup_escape_text (summary, -1);
-	g_string_append_printf (string, "%s\n", summary_safe);
-	g_string_append_printf (string, "<span color=\"%s\">", color);
-	g_string_append (string, split[PK_PACKAGE_ID_NAME]);
-	if (split[PK_PACKAGE_ID_VERSION][0] != '\0')
-		g_string_append_printf (string, "-%s", split[PK_PACKAGE_ID_VERSION]);
-	arch = gpk_get_pretty_arch (split[PK_PACKAGE_ID_ARCH]);
-	if (arch != NULL)
-		g_string_append_printf (string, " (%s)", arch);
-	g_string_append (string, "</span>");
+	string = g_string_sized_new (128);
+	if (summary != NULL && summary[0] != '\0') {
+		summary_safe = g_markup_escape_text (summary, -1);
+		g_string_append (string, summary_safe);
+		g_string_append (string, "\n<span color=\"");
+		g_string_append (string, color);
+		g_string_append (string, "\">");
+	}
+	tmp = gpk_package_id_view_get (&view, PK_PACKAGE_ID_NAME, &len);
+	g_string_append_len (string, tmp, len);
+	tmp = gpk_package_id_view_get (&view, PK_PACKAGE_ID_VERSION, &len);
+	if (len > 0) {
+		g_string_append_c (string, '-');
+		g_string_append_len (string, tmp, len);
+	}
+	tmp = gpk_package_id_view_get (&view, PK_PACKAGE_ID_ARCH, &len);
+	arch = gpk_get_pretty_arch (tmp, len);
+	if (arch != NULL) {
+		g_string_append (string, " (");
+		g_string_append (string, arch);
+		g_string_append_c (string, ')');
+	}
+	if (summary_safe != NULL)
+		g_string_append (string, "</span>");
 	return g_string_free (string, FALSE);
 }
 
+gchar *
+gpk_package_id_format_twoline (GtkStyleContext *style,
+			       const gchar *package_id,
+			       const gchar *summary)
+{
+	g_autofree gchar *color = NULL;
+
+	g_return_val_if_fail (package_id != NULL, NULL);
+
+	/* get style color */
+	color = gpk_style_context_get_inactive_color (style);
+	return gpk_package_id_format_twoline_color (color, package_id, summary);
+}
+
 gchar *
 gpk_package_id_format_oneline (const gchar *package_id, const gchar *summary)
 {
 	g_autofree gchar *summary_safe = NULL;
-	g_auto(GStrv) split = NULL;
+	GpkPackageIdView view;
+	const gchar *name;
+	guint len;
 
 	g_return_val_if_fail (package_id != NULL, NULL);
 
-	split = pk_package_id_split (package_id);
+	if (!gpk_package_id_view_parse (&view, package_id))
+		return NULL;
+	name = gpk_package_id_view_get (&view, PK_PACKAGE_ID_NAME, &len);
 	if (summary == NULL || summary[0] == '\0') {
 		/* just have name */
-		return g_strdup (split[PK_PACKAGE_ID_NAME]);
+		return g_strndup (name, len);
 	}
 	summary_safe = g_markup_escape_text (summary, -1);
-	return g_strdup_printf ("<b>%s</b> (%s)", summary_safe, split[PK_PACKAGE_ID_NAME]);
+	return g_strdup_printf ("<b>%s</b> (%.*s)", summary_safe, (gint) len, name);
 }
 
 gboolean
@@ -317,3 +443,91 @@ gpk_strv_join_locale (gchar **array)
 					array[3], array[4]);
 	return NULL;
 }
+
+/**
+ * gpk_category_array_to_tree:
+ * @array: the #PkCategory objects as returned by GetCategories()
+ *
+ * Arranges the categories into a tree using the parent-id of each one.
+ * The tree can be any depth, and siblings are kept in the same order as
+ * they appear in @array. Categories without a known parent are added to
+ * the top level, and categories that cannot be reached from the top level
+ * (for instance, a loop of parent IDs) are dropped.
+ *
+ * Return value: a #GNode with no data, whose children point at the
+ * borrowed #PkCategory objects; free with g_node_destroy()
+ **/
+GNode *
+gpk_category_array_to_tree (GPtrArray *array)
+{
+	GNode *node;
+	GNode *root;
+	GPtrArray *children;
+	GQueue queue = G_QUEUE_INIT;
+	PkCategory *item;
+	const gchar *cat_id;
+	const gchar *parent_id;
+	guint i;
+	g_autoptr(GHashTable) cat_ids = NULL;
+	g_autoptr(GHashTable) parents = NULL;
+	g_autoptr(GPtrArray) toplevel = NULL;
+
+	/* index every category by its own ID */
+	cat_ids = g_hash_table_new (g_str_hash, g_str_equal);
+	for (i = 0; i < array->len; i++) {
+		item = g_ptr_array_index (array, i);
+		cat_id = pk_category_get_id (item);
+		if (cat_id != NULL)
+			g_hash_table_insert (cat_ids, (gpointer) cat_id, item);
+	}
+
+	/* bucket the categories by parent */
+	toplevel = g_ptr_array_new ();
+	parents = g_hash_table_new_full (g_str_hash, g_str_equal,
+					 NULL, (GDestroyNotify) g_ptr_array_unref);
+	for (i = 0; i < array->len; i++) {
+		item = g_ptr_array_index (array, i);
+		cat_id = pk_category_get_id (item);
+		parent_id = pk_category_get_parent_id (item);
+		if (parent_id == NULL || parent_id[0] == '\0' ||
+		    g_strcmp0 (parent_id, cat_id) == 0 ||
+		    !g_hash_table_contains (cat_ids, parent_id)) {
+			g_ptr_array_add (toplevel, item);
+			continue;
+		}
+		children = g_hash_table_lookup (parents, parent_id);
+		if (children == NULL) {
+			children = g_ptr_array_new ();
+			g_hash_table_insert (parents, (gpointer) parent_id, children);
+		}
+		g_ptr_array_add (children, item);
+	}
+
+	/* build the tree from the top down; each bucket is only used once so
+	 * duplicate or looping IDs cannot make the tree grow forever */
+	root = g_node_new (NULL);
+	children = toplevel;
+	node = root;
+	do {
+		/* prepend in reverse, as appending has to find the last sibling */
+		for (i = children->len; i > 0; i--) {
+			GNode *child = g_node_prepend_data (node, g_ptr_array_index (children, i - 1));
+			g_queue_push_tail (&queue, child);
+		}
+		if (children != toplevel)
+			g_hash_table_remove (parents, pk_category_get_id (node->data));
+
+		/* find the next node that has children */
+		children = NULL;
+		while (children == NULL && (node = g_queue_pop_head (&queue)) != NULL) {
+			cat_id = pk_category_get_id (node->data);
+			if (cat_id != NULL)
+				children = g_hash_table_lookup (parents, cat_id);
+		}
+	} while (children != NULL);
+
+	if (g_hash_table_size (parents) > 0)
+		g_debug ("ignoring %u unreachable category groups",
+			 g_hash_table_size (parents));
+	return root;
+}
@@ -59,11 +59,35 @@ G_BEGIN_DECLS
 /* any status that is slower than this will not be shown in the UI */
 #define GPK_UI_STATUS_SHOW_DELAY		750 /* ms */
 
+/* the fields of a package ID, indexed by PK_PACKAGE_ID_NAME etc. */
+typedef struct {
+	const gchar	*package_id;
+	guint		 offset[4];
+	guint		 len[4];
+} GpkPackageIdView;
+
 gchar		*gpk_package_id_format_twoline		(GtkStyleContext *style,
 							 const gchar 	*package_id,
 							 const gchar	*summary);
+gchar		*gpk_package_id_format_twoline_color	(const gchar	*color,
+							 const gchar 	*package_id,
+							 const gchar	*summary);
+gchar		*gpk_style_context_get_inactive_color	(GtkStyleContext *style);
 gchar		*gpk_package_id_format_oneline		(const gchar 	*package_id,
 							 const gchar	*summary);
+gboolean	 gpk_package_id_view_parse		(GpkPackageIdView *view,
+							 const gchar	*package_id);
+const gchar	*gpk_package_id_view_get		(const GpkPackageIdView *view,
+							 guint		 field,
+							 guint		*len);
+gchar		*gpk_package_id_view_dup		(const GpkPackageIdView *view,
+							 guint		 field);
+gboolean	 gpk_package_id_view_equal		(const GpkPackageIdView *view,
+							 guint		 field,
+							 const gchar	*str);
+gboolean	 gpk_package_id_view_contains		(const GpkPackageIdView *view,
+							 guint		 field,
+							 const gchar	*needle);
 gboolean	 gpk_check_privileged_user		(const gchar	*application_name,
 							 gboolean	 show_ui);
 gchar		*gpk_strv_join_locale			(gchar		**array);
@@ -74,6 +98,8 @@ gboolean	 gpk_window_set_parent_xid		(GtkWindow	*window,
 							 guint32	 xid);
 GPtrArray	*pk_strv_to_ptr_array			(gchar		**array)
 							 G_GNUC_WARN_UNUSED_RESULT;
+GNode		*gpk_category_array_to_tree		(GPtrArray	*array)
+							 G_GNUC_WARN_UNUSED_RESULT;
 
 G_END_DECLS
 
@@ -29,6 +29,7 @@
 
 static gboolean _verbose = FALSE;
 static gboolean _console = FALSE;
+static gboolean _stats = FALSE;
 
 static void
 gpk_debug_ignore_cb (const gchar *log_domain, GLogLevelFlags log_level,
@@ -102,6 +103,9 @@ gpk_debug_pre_parse_hook (GOptionContext *context, GOptionGroup *group, gpointer
 		{ "verbose", 'v', 0, G_OPTION_ARG_NONE, &_verbose,
 		  /* TRANSLATORS: turn on all debugging */
 		  N_("Show debugging information for all files"), NULL },
+		{ "stats", '\0', 0, G_OPTION_ARG_NONE, &_stats,
+		  /* TRANSLATORS: show how well the caches are working */
+		  N_("Show cache statistics"), NULL },
 		{ NULL}
 	};
 
@@ -129,6 +133,54 @@ gpk_debug_add_log_domain (const gchar *log_domain)
 	}
 }
 
+/**
+ * gpk_debug_stats:
+ * @name: the name of the cache, e.g. "details"
+ * @hits: the number of lookups that were found
+ * @misses: the number of lookups that were not found
+ *
+ * Prints the hit rate of a cache if --stats was given, or as debugging
+ * otherwise.
+ **/
+void
+gpk_debug_stats (const gchar *name, guint hits, guint misses)
+{
+	guint total = hits + misses;
+	gdouble rate = total > 0 ? 100.f * hits / total : 0.f;
+
+	if (_stats) {
+		g_print ("%s cache: %u of %u lookups hit (%.1f%%)\n",
+			 name, hits, total, rate);
+		return;
+	}
+	g_debug ("%s cache: %u of %u lookups hit (%.1f%%)",
+		 name, hits, total, rate);
+}
+
+/**
+ * gpk_debug_memory:
+ * @name: the name of the pool, e.g. "string"
+ * @size: the number of bytes used
+ * @saved: the number of bytes that sharing saved
+ *
+ * Prints how much memory sharing saved if --stats was given, or as
+ * debugging otherwise.
+ **/
+void
+gpk_debug_memory (const gchar *name, gsize size, gsize saved)
+{
+	g_autofree gchar *size_str = g_format_size (size);
+	g_autofree gchar *saved_str = g_format_size (saved);
+
+	if (_stats) {
+		g_print ("%s pool: %s used, %s saved\n",
+			 name, size_str, saved_str);
+		return;
+	}
+	g_debug ("%s pool: %s used, %s saved",
+		 name, size_str, saved_str);
+}
+
 static gboolean
 gpk_debug_post_parse_hook (GOptionContext *context, GOptionGroup *group, gpointer data, GError **error)
 {
@@ -26,5 +26,11 @@
 
 GOptionGroup	*gpk_debug_get_option_group	(void);
 void		 gpk_debug_add_log_domain	(const gchar	*log_domain);
+void		 gpk_debug_stats		(const gchar	*name,
+						 guint		 hits,
+						 guint		 misses);
+void		 gpk_debug_memory		(const gchar	*name,
+						 gsize		 size,
+						 gsize		 saved);
 
 #endif /* __GPK_DEBUG_H__ */
@@ -0,0 +1,246 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib.h>
+#include <packagekit-glib2/packagekit.h>
+
+#include "gpk-details-cache.h"
+
+typedef struct {
+	gchar			*package_id;
+	PkDetails		*details;
+	gsize			 size;
+} GpkDetailsCacheItem;
+
+struct _GpkDetailsCache
+{
+	GObject			 parent_instance;
+	GQueue			*lru;		/* of GpkDetailsCacheItem, newest first */
+	GHashTable		*index;		/* package_id : GList in lru */
+	gsize			 size;
+	gsize			 max_size;
+	guint			 hits;
+	guint			 misses;
+};
+
+G_DEFINE_TYPE (GpkDetailsCache, gpk_details_cache, G_TYPE_OBJECT)
+
+static void
+gpk_details_cache_item_free (GpkDetailsCacheItem *item)
+{
+	g_free (item->package_id);
+	g_object_unref (item->details);
+	g_free (item);
+}
+
+static gsize
+gpk_details_cache_strlen (const gchar *str)
+{
+	return str != NULL ? strlen (str) + 1 : 0;
+}
+
+/* roughly what the object and its strings use */
+static gsize
+gpk_details_cache_get_item_size (GpkDetailsCacheItem *item)
+{
+	gsize size = sizeof (GpkDetailsCacheItem) + sizeof (GList) + 128;
+	size += 2 * gpk_details_cache_strlen (item->package_id);
+	size += gpk_details_cache_strlen (pk_details_get_summary (item->details));
+	size += gpk_details_cache_strlen (pk_details_get_license (item->details));
+	size += gpk_details_cache_strlen (pk_details_get_description (item->details));
+	size += gpk_details_cache_strlen (pk_details_get_url (item->details));
+	return size;
+}
+
+static void
+gpk_details_cache_remove_link (GpkDetailsCache *cache, GList *link)
+{
+	GpkDetailsCacheItem *item = link->data;
+
+	g_hash_table_remove (cache->index, item->package_id);
+	g_queue_delete_link (cache->lru, link);
+	cache->size -= item->size;
+	gpk_details_cache_item_free (item);
+}
+
+/**
+ * gpk_details_cache_lookup:
+ *
+ * Return value: (transfer none): the cached details, or %NULL
+ **/
+PkDetails *
+gpk_details_cache_lookup (GpkDetailsCache *cache, const gchar *package_id)
+{
+	GList *link;
+	GpkDetailsCacheItem *item;
+
+	g_return_val_if_fail (GPK_IS_DETAILS_CACHE (cache), NULL);
+	g_return_val_if_fail (package_id != NULL, NULL);
+
+	link = g_hash_table_lookup (cache->index, package_id);
+	if (link == NULL) {
+		cache->misses++;
+		return NULL;
+	}
+	cache->hits++;
+
+	/* now the most recently used */
+	g_queue_unlink (cache->lru, link);
+	g_queue_push_head_link (cache->lru, link);
+	item = link->data;
+	return item->details;
+}
+
+/**
+ * gpk_details_cache_contains:
+ *
+ * Like gpk_details_cache_lookup() but does not count as a use.
+ **/
+gboolean
+gpk_details_cache_contains (GpkDetailsCache *cache, const gchar *package_id)
+{
+	g_return_val_if_fail (GPK_IS_DETAILS_CACHE (cache), FALSE);
+	g_return_val_if_fail (package_id != NULL, FALSE);
+	return g_hash_table_contains (cache->index, package_id);
+}
+
+/**
+ * gpk_details_cache_add:
+ *
+ * Adds the details, replacing any for the same package, and then drops
+ * the least recently used details until the cache is small enough.
+ **/
+void
+gpk_details_cache_add (GpkDetailsCache *cache, PkDetails *details)
+{
+	GList *link;
+	GpkDetailsCacheItem *item;
+	const gchar *package_id;
+
+	g_return_if_fail (GPK_IS_DETAILS_CACHE (cache));
+	g_return_if_fail (PK_IS_DETAILS (details));
+
+	package_id = pk_details_get_package_id (details);
+	if (package_id == NULL)
+		return;
+	link = g_hash_table_lookup (cache->index, package_id);
+	if (link != NULL)
+		gpk_details_cache_remove_link (cache, link);
+
+	item = g_new0 (GpkDetailsCacheItem, 1);
+	item->package_id = g_strdup (package_id);
+	item->details = g_object_ref (details);
+	item->size = gpk_details_cache_get_item_size (item);
+	g_queue_push_head (cache->lru, item);
+	g_hash_table_insert (cache->index, item->package_id, cache->lru->head);
+	cache->size += item->size;
+
+	/* always keep the newest, even if it is too big on its own */
+	while (cache->size > cache->max_size && cache->lru->length > 1)
+		gpk_details_cache_remove_link (cache, cache->lru->tail);
+}
+
+/**
+ * gpk_details_cache_invalidate:
+ **/
+void
+gpk_details_cache_invalidate (GpkDetailsCache *cache)
+{
+	g_return_if_fail (GPK_IS_DETAILS_CACHE (cache));
+
+	g_hash_table_remove_all (cache->index);
+	g_queue_free_full (cache->lru, (GDestroyNotify) gpk_details_cache_item_free);
+	cache->lru = g_queue_new ();
+	cache->size = 0;
+}
+
+/**
+ * gpk_details_cache_get_size:
+ *
+ * Return value: the approximate number of bytes used by the cached details
+ **/
+gsize
+gpk_details_cache_get_size (GpkDetailsCache *cache)
+{
+	g_return_val_if_fail (GPK_IS_DETAILS_CACHE (cache), 0);
+	return cache->size;
+}
+
+/**
+ * gpk_details_cache_get_hits:
+ **/
+guint
+gpk_details_cache_get_hits (GpkDetailsCache *cache)
+{
+	g_return_val_if_fail (GPK_IS_DETAILS_CACHE (cache), 0);
+	return cache->hits;
+}
+
+/**
+ * gpk_details_cache_get_misses:
+ **/
+guint
+gpk_details_cache_get_misses (GpkDetailsCache *cache)
+{
+	g_return_val_if_fail (GPK_IS_DETAILS_CACHE (cache), 0);
+	return cache->misses;
+}
+
+static void
+gpk_details_cache_finalize (GObject *object)
+{
+	GpkDetailsCache *cache = GPK_DETAILS_CACHE (object);
+
+	g_hash_table_unref (cache->index);
+	g_queue_free_full (cache->lru, (GDestroyNotify) gpk_details_cache_item_free);
+
+	G_OBJECT_CLASS (gpk_details_cache_parent_class)->finalize (object);
+}
+
+static void
+gpk_details_cache_class_init (GpkDetailsCacheClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	object_class->finalize = gpk_details_cache_finalize;
+}
+
+static void
+gpk_details_cache_init (GpkDetailsCache *cache)
+{
+	cache->lru = g_queue_new ();
+	cache->index = g_hash_table_new (g_str_hash, g_str_equal);
+}
+
+/**
+ * gpk_details_cache_new:
+ * @max_size: the approximate number of bytes the cache can use
+ **/
+GpkDetailsCache *
+gpk_details_cache_new (gsize max_size)
+{
+	GpkDetailsCache *cache;
+	cache = g_object_new (GPK_TYPE_DETAILS_CACHE, NULL);
+	cache->max_size = max_size;
+	return cache;
+}
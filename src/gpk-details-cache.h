@@ -0,0 +1,48 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef GPK_DETAILS_CACHE_H
+#define GPK_DETAILS_CACHE_H
+
+#include <glib-object.h>
+#include <packagekit-glib2/packagekit.h>
+
+G_BEGIN_DECLS
+
+#define GPK_TYPE_DETAILS_CACHE (gpk_details_cache_get_type())
+G_DECLARE_FINAL_TYPE (GpkDetailsCache, gpk_details_cache, GPK, DETAILS_CACHE, GObject)
+
+GType		 gpk_details_cache_get_type		(void);
+GpkDetailsCache	*gpk_details_cache_new			(gsize		 max_size);
+PkDetails	*gpk_details_cache_lookup		(GpkDetailsCache *cache,
+							 const gchar	*package_id);
+gboolean	 gpk_details_cache_contains		(GpkDetailsCache *cache,
+							 const gchar	*package_id);
+void		 gpk_details_cache_add			(GpkDetailsCache *cache,
+							 PkDetails	*details);
+void		 gpk_details_cache_invalidate		(GpkDetailsCache *cache);
+gsize		 gpk_details_cache_get_size		(GpkDetailsCache *cache);
+guint		 gpk_details_cache_get_hits		(GpkDetailsCache *cache);
+guint		 gpk_details_cache_get_misses		(GpkDetailsCache *cache);
+
+G_END_DECLS
+
+#endif /* GPK_DETAILS_CACHE_H */
@@ -49,13 +49,12 @@ gpk_dialog_package_id_name_join_locale (gchar **package_ids)
 	length = g_strv_length (package_ids);
 	array = g_ptr_array_new_with_free_func (g_free);
 	for (i = 0; i < length; i++) {
-		g_auto(GStrv) split = NULL;
-		split = pk_package_id_split (package_ids[i]);
-		if (split == NULL) {
+		GpkPackageIdView view;
+		if (!gpk_package_id_view_parse (&view, package_ids[i])) {
 			g_warning ("failed to split %s", package_ids[i]);
 			continue;
 		}
-		g_ptr_array_add (array, g_strdup (split[0]));
+		g_ptr_array_add (array, gpk_package_id_view_dup (&view, PK_PACKAGE_ID_NAME));
 	}
 	array_strv = pk_ptr_array_to_strv (array);
 	text = gpk_strv_join_locale (array_strv);
@@ -80,7 +79,6 @@ gpk_dialog_package_array_to_list_store (GPtrArray *array)
 
 	/* add each well */
 	for (i = 0; i < array->len; i++) {
-		g_auto(GStrv) split = NULL;
 		g_autofree gchar *text = NULL;
 		g_autofree gchar *package_id = NULL;
 		g_autofree gchar *summary = NULL;
@@ -93,7 +91,6 @@ gpk_dialog_package_array_to_list_store (GPtrArray *array)
 		text = gpk_package_id_format_twoline (NULL, package_id, summary);
 
 		/* get the icon */
-		split = pk_package_id_split (package_id);
 		icon = gpk_info_enum_to_icon_name (info);
 
 		gtk_list_store_append (store, &iter);
@@ -0,0 +1,44 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __GPK_ENUM_PRIVATE_H
+#define __GPK_ENUM_PRIVATE_H
+
+#include <glib-object.h>
+#include <packagekit-glib2/packagekit.h>
+
+G_BEGIN_DECLS
+
+/* these build the lookup tables, and are only used directly by the
+ * self test to check the tables against them */
+const gchar	*gpk_status_enum_to_localised_text_real	(PkStatusEnum	 status);
+const gchar	*gpk_info_enum_to_localised_text_real	(PkInfoEnum	 info);
+const gchar	*gpk_info_enum_to_localised_present_real (PkInfoEnum	 info);
+const gchar	*gpk_info_enum_to_localised_past_real	(PkInfoEnum	 info);
+const gchar	*gpk_role_enum_to_localised_past_real	(PkRoleEnum	 role);
+const gchar	*gpk_group_enum_to_localised_text_real	(PkGroupEnum	 group);
+void		 gpk_enum_icons_fill			(const gchar	**table,
+							 guint		 len,
+							 const PkEnumMatch *match);
+
+G_END_DECLS
+
+#endif	/* __GPK_ENUM_PRIVATE_H */
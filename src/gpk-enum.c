@@ -26,6 +26,7 @@
 #include <packagekit-glib2/packagekit.h>
 
 #include "gpk-enum.h"
+#include "gpk-enum-private.h"
 #include "gpk-common.h"
 
 /* icon names */
@@ -740,7 +741,7 @@ gpk_restart_enum_to_localised_text (PkRestartEnum restart)
 }
 
 const gchar *
-gpk_status_enum_to_localised_text (PkStatusEnum status)
+gpk_status_enum_to_localised_text_real (PkStatusEnum status)
 {
 	const gchar *text = NULL;
 	switch (status) {
@@ -889,13 +890,13 @@ gpk_status_enum_to_localised_text (PkStatusEnum status)
 		text = _("Copying files");
 		break;
 	default:
-		g_warning ("status unrecognized: %s", pk_status_enum_to_string (status));
+		break;
 	}
 	return text;
 }
 
 const gchar *
-gpk_info_enum_to_localised_text (PkInfoEnum info)
+gpk_info_enum_to_localised_text_real (PkInfoEnum info)
 {
 	const gchar *text = NULL;
 	switch (info) {
@@ -946,13 +947,13 @@ gpk_info_enum_to_localised_text (PkInfoEnum info)
 		text = _("Untrusted");
 		break;
 	default:
-		g_warning ("info unrecognized: %s", pk_info_enum_to_string (info));
+		break;
 	}
 	return text;
 }
 
-static const gchar *
-gpk_info_enum_to_localised_present (PkInfoEnum info)
+const gchar *
+gpk_info_enum_to_localised_present_real (PkInfoEnum info)
 {
 	const gchar *text = NULL;
 	switch (info) {
@@ -993,13 +994,13 @@ gpk_info_enum_to_localised_present (PkInfoEnum info)
 		text = _("Decompressing");
 		break;
 	default:
-		g_warning ("info unrecognized: %s", pk_info_enum_to_string (info));
+		break;
 	}
 	return text;
 }
 
 const gchar *
-gpk_info_enum_to_localised_past (PkInfoEnum info)
+gpk_info_enum_to_localised_past_real (PkInfoEnum info)
 {
 	const gchar *text = NULL;
 	switch (info) {
@@ -1031,6 +1032,10 @@ gpk_info_enum_to_localised_past (PkInfoEnum info)
 		/* TRANSLATORS: The action of the package, in past tense */
 		text = _("Reinstalled");
 		break;
+	case PK_INFO_ENUM_DOWNGRADING:
+		/* TRANSLATORS: The action of the package, in past tense */
+		text = _("Downgraded");
+		break;
 	case PK_INFO_ENUM_PREPARING:
 		/* TRANSLATORS: The action of the package, in past tense */
 		text = _("Prepared");
@@ -1040,13 +1045,13 @@ gpk_info_enum_to_localised_past (PkInfoEnum info)
 		text = _("Decompressed");
 		break;
 	default:
-		g_warning ("info unrecognized: %s", pk_info_enum_to_string (info));
+		break;
 	}
 	return text;
 }
 
 const gchar *
-gpk_role_enum_to_localised_past (PkRoleEnum role)
+gpk_role_enum_to_localised_past_real (PkRoleEnum role)
 {
 	const gchar *text = NULL;
 	switch (role) {
@@ -1177,13 +1182,13 @@ gpk_role_enum_to_localised_past (PkRoleEnum role)
 		text = _("Repaired the system");
 		break;
 	default:
-		g_warning ("role unrecognized: %s", pk_role_enum_to_string (role));
+		break;
 	}
 	return text;
 }
 
 const gchar *
-gpk_group_enum_to_localised_text (PkGroupEnum group)
+gpk_group_enum_to_localised_text_real (PkGroupEnum group)
 {
 	const gchar *text = NULL;
 	switch (group) {
@@ -1328,40 +1333,194 @@ gpk_group_enum_to_localised_text (PkGroupEnum group)
 		text = _("Unknown group");
 		break;
 	default:
-		g_warning ("group unrecognized: %i", group);
+		break;
 	}
 	return text;
 }
 
+/*
+ * The strings are looked up for every row and every progress event, so
+ * rather than running the switch and gettext each time they are put in
+ * tables indexed by the enum value the first time any are needed.
+ */
+typedef struct {
+	const gchar		*status_text[PK_STATUS_ENUM_LAST];
+	const gchar		*info_text[PK_INFO_ENUM_LAST];
+	const gchar		*info_present[PK_INFO_ENUM_LAST];
+	const gchar		*info_past[PK_INFO_ENUM_LAST];
+	const gchar		*role_past[PK_ROLE_ENUM_LAST];
+	const gchar		*group_text[PK_GROUP_ENUM_LAST];
+} GpkEnumLocalised;
+
+typedef struct {
+	const gchar		*info[PK_INFO_ENUM_LAST];
+	const gchar		*status[PK_STATUS_ENUM_LAST];
+	const gchar		*role[PK_ROLE_ENUM_LAST];
+	const gchar		*group[PK_GROUP_ENUM_LAST];
+	const gchar		*restart[PK_RESTART_ENUM_LAST];
+} GpkEnumIcons;
+
+static GpkEnumLocalised	 enum_localised;
+static gsize		 enum_localised_valid = 0;
+static GpkEnumIcons	 enum_icons;
+static gsize		 enum_icons_valid = 0;
+
+static const GpkEnumLocalised *
+gpk_enum_get_localised (void)
+{
+	guint i;
+
+	/* the locale is set in main() before any of these are used */
+	if (g_once_init_enter (&enum_localised_valid)) {
+		for (i = 0; i < PK_STATUS_ENUM_LAST; i++)
+			enum_localised.status_text[i] = gpk_status_enum_to_localised_text_real (i);
+		for (i = 0; i < PK_INFO_ENUM_LAST; i++) {
+			enum_localised.info_text[i] = gpk_info_enum_to_localised_text_real (i);
+			enum_localised.info_present[i] = gpk_info_enum_to_localised_present_real (i);
+			enum_localised.info_past[i] = gpk_info_enum_to_localised_past_real (i);
+		}
+		for (i = 0; i < PK_ROLE_ENUM_LAST; i++)
+			enum_localised.role_past[i] = gpk_role_enum_to_localised_past_real (i);
+		for (i = 0; i < PK_GROUP_ENUM_LAST; i++)
+			enum_localised.group_text[i] = gpk_group_enum_to_localised_text_real (i);
+		g_once_init_leave (&enum_localised_valid, 1);
+	}
+	return &enum_localised;
+}
+
+void
+gpk_enum_icons_fill (const gchar **table, guint len, const PkEnumMatch *match)
+{
+	guint i;
+
+	/* the first entry is the fallback, and the first match wins */
+	for (i = 0; i < len; i++)
+		table[i] = match[0].string;
+	for (i = 0; match[i].string != NULL; i++);
+	while (i-- > 0) {
+		if (match[i].value < len)
+			table[match[i].value] = match[i].string;
+	}
+}
+
+static const GpkEnumIcons *
+gpk_enum_get_icons (void)
+{
+	if (g_once_init_enter (&enum_icons_valid)) {
+		gpk_enum_icons_fill (enum_icons.info, PK_INFO_ENUM_LAST, enum_info_icon_name);
+		gpk_enum_icons_fill (enum_icons.status, PK_STATUS_ENUM_LAST, enum_status_icon_name);
+		gpk_enum_icons_fill (enum_icons.role, PK_ROLE_ENUM_LAST, enum_role_icon_name);
+		gpk_enum_icons_fill (enum_icons.group, PK_GROUP_ENUM_LAST, enum_group_icon_name);
+		gpk_enum_icons_fill (enum_icons.restart, PK_RESTART_ENUM_LAST, enum_restart_icon_name);
+		g_once_init_leave (&enum_icons_valid, 1);
+	}
+	return &enum_icons;
+}
+
+const gchar *
+gpk_status_enum_to_localised_text (PkStatusEnum status)
+{
+	const gchar *text = NULL;
+	if ((guint) status < PK_STATUS_ENUM_LAST)
+		text = gpk_enum_get_localised ()->status_text[status];
+	if (text == NULL)
+		g_warning ("status unrecognized: %s", pk_status_enum_to_string (status));
+	return text;
+}
+
+const gchar *
+gpk_info_enum_to_localised_text (PkInfoEnum info)
+{
+	const gchar *text = NULL;
+	if ((guint) info < PK_INFO_ENUM_LAST)
+		text = gpk_enum_get_localised ()->info_text[info];
+	if (text == NULL)
+		g_warning ("info unrecognized: %s", pk_info_enum_to_string (info));
+	return text;
+}
+
+static const gchar *
+gpk_info_enum_to_localised_present (PkInfoEnum info)
+{
+	const gchar *text = NULL;
+	if ((guint) info < PK_INFO_ENUM_LAST)
+		text = gpk_enum_get_localised ()->info_present[info];
+	if (text == NULL)
+		g_warning ("info unrecognized: %s", pk_info_enum_to_string (info));
+	return text;
+}
+
+const gchar *
+gpk_info_enum_to_localised_past (PkInfoEnum info)
+{
+	const gchar *text = NULL;
+	if ((guint) info < PK_INFO_ENUM_LAST)
+		text = gpk_enum_get_localised ()->info_past[info];
+	if (text == NULL)
+		g_warning ("info unrecognized: %s", pk_info_enum_to_string (info));
+	return text;
+}
+
+const gchar *
+gpk_role_enum_to_localised_past (PkRoleEnum role)
+{
+	const gchar *text = NULL;
+	if ((guint) role < PK_ROLE_ENUM_LAST)
+		text = gpk_enum_get_localised ()->role_past[role];
+	if (text == NULL)
+		g_warning ("role unrecognized: %s", pk_role_enum_to_string (role));
+	return text;
+}
+
+const gchar *
+gpk_group_enum_to_localised_text (PkGroupEnum group)
+{
+	const gchar *text = NULL;
+	if ((guint) group < PK_GROUP_ENUM_LAST)
+		text = gpk_enum_get_localised ()->group_text[group];
+	if (text == NULL)
+		g_warning ("group unrecognized: %i", group);
+	return text;
+}
+
 const gchar *
 gpk_info_enum_to_icon_name (PkInfoEnum info)
 {
-	return pk_enum_find_string (enum_info_icon_name, info);
+	if ((guint) info >= PK_INFO_ENUM_LAST)
+		return enum_info_icon_name[0].string;
+	return gpk_enum_get_icons ()->info[info];
 }
 
 const gchar *
 gpk_status_enum_to_icon_name (PkStatusEnum status)
 {
-	return pk_enum_find_string (enum_status_icon_name, status);
+	if ((guint) status >= PK_STATUS_ENUM_LAST)
+		return enum_status_icon_name[0].string;
+	return gpk_enum_get_icons ()->status[status];
 }
 
 const gchar *
 gpk_role_enum_to_icon_name (PkRoleEnum role)
 {
-	return pk_enum_find_string (enum_role_icon_name, role);
+	if ((guint) role >= PK_ROLE_ENUM_LAST)
+		return enum_role_icon_name[0].string;
+	return gpk_enum_get_icons ()->role[role];
 }
 
 const gchar *
 gpk_group_enum_to_icon_name (PkGroupEnum group)
 {
-	return pk_enum_find_string (enum_group_icon_name, group);
+	if ((guint) group >= PK_GROUP_ENUM_LAST)
+		return enum_group_icon_name[0].string;
+	return gpk_enum_get_icons ()->group[group];
 }
 
 const gchar *
 gpk_restart_enum_to_icon_name (PkRestartEnum restart)
 {
-	const gchar *tmp;
-	tmp = pk_enum_find_string (enum_restart_icon_name, restart);
+	const gchar *tmp = enum_restart_icon_name[0].string;
+	if ((guint) restart < PK_RESTART_ENUM_LAST)
+		tmp = gpk_enum_get_icons ()->restart[restart];
 	if (tmp[0] == '\0')
 		tmp = NULL;
 	return tmp;
@@ -0,0 +1,336 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib.h>
+
+#include "gpk-common.h"
+#include "gpk-log-index.h"
+
+/*
+ * The transactions are parsed once into a struct of arrays. All the text
+ * that the filter looks at, i.e. the command line, and the info type,
+ * name, version and arch of each package, is copied into one buffer with
+ * each field NUL terminated, so a search is a single pass over the
+ * buffer rather than splitting the data of each transaction again.
+ */
+typedef struct {
+	guint			 start;		/* in text */
+	guint			 end;
+} GpkLogIndexSpan;
+
+struct _GpkLogIndex
+{
+	GObject			 parent_instance;
+	GArray			*roles;		/* of guint8 */
+	GArray			*timestamps;	/* of gint64 */
+	GArray			*uids;		/* of guint */
+	GArray			*succeeded;	/* of guint8 */
+	GArray			*spans;		/* of GpkLogIndexSpan */
+	GString			*text;
+};
+
+G_DEFINE_TYPE (GpkLogIndex, gpk_log_index, G_TYPE_OBJECT)
+
+static void
+gpk_log_index_append_field (GpkLogIndex *log_index, const gchar *str, gsize len)
+{
+	g_string_append_len (log_index->text, str, len);
+	g_string_append_c (log_index->text, '\0');
+}
+
+/**
+ * gpk_log_index_add:
+ *
+ * Parses a transaction, which is given the next index.
+ **/
+void
+gpk_log_index_add (GpkLogIndex *log_index, PkTransactionPast *item)
+{
+	GpkLogIndexSpan span;
+	GpkPackageIdView view;
+	PkRoleEnum role;
+	const gchar *line;
+	const gchar *end;
+	const gchar *tab;
+	const gchar *tmp;
+	gboolean succeeded;
+	gint64 timestamp = 0;
+	guint uid;
+	guint len;
+	guint8 val;
+	GTimeVal timeval;
+	g_autofree gchar *cmdline = NULL;
+	g_autofree gchar *data = NULL;
+	g_autofree gchar *timespec = NULL;
+
+	g_return_if_fail (GPK_IS_LOG_INDEX (log_index));
+
+	g_object_get (item,
+		      "role", &role,
+		      "timespec", &timespec,
+		      "succeeded", &succeeded,
+		      "cmdline", &cmdline,
+		      "uid", &uid,
+		      "data", &data,
+		      NULL);
+
+	val = role;
+	g_array_append_val (log_index->roles, val);
+	if (timespec != NULL && g_time_val_from_iso8601 (timespec, &timeval))
+		timestamp = timeval.tv_sec;
+	g_array_append_val (log_index->timestamps, timestamp);
+	g_array_append_val (log_index->uids, uid);
+	val = succeeded;
+	g_array_append_val (log_index->succeeded, val);
+
+	/* the command line is always the first field */
+	span.start = log_index->text->len;
+	gpk_log_index_append_field (log_index, cmdline != NULL ? cmdline : "",
+				    cmdline != NULL ? strlen (cmdline) : 0);
+
+	/* each line is "info\tpackage_id\tsummary" */
+	for (line = data; line != NULL && *line != '\0'; line = end) {
+		end = strchr (line, '\n');
+		if (end == NULL)
+			end = line + strlen (line);
+		tab = memchr (line, '\t', end - line);
+		if (tab == NULL) {
+			gpk_log_index_append_field (log_index, line, end - line);
+		} else {
+			g_autofree gchar *package_id = NULL;
+			gpk_log_index_append_field (log_index, line, tab - line);
+			tmp = memchr (tab + 1, '\t', end - tab - 1);
+			if (tmp == NULL)
+				tmp = end;
+			package_id = g_strndup (tab + 1, tmp - tab - 1);
+			if (gpk_package_id_view_parse (&view, package_id)) {
+				tmp = gpk_package_id_view_get (&view, PK_PACKAGE_ID_NAME, &len);
+				gpk_log_index_append_field (log_index, tmp, len);
+				tmp = gpk_package_id_view_get (&view, PK_PACKAGE_ID_VERSION, &len);
+				gpk_log_index_append_field (log_index, tmp, len);
+				tmp = gpk_package_id_view_get (&view, PK_PACKAGE_ID_ARCH, &len);
+				gpk_log_index_append_field (log_index, tmp, len);
+			}
+		}
+		if (*end == '\n')
+			end++;
+	}
+	span.end = log_index->text->len;
+	g_array_append_val (log_index->spans, span);
+}
+
+/**
+ * gpk_log_index_clear:
+ **/
+void
+gpk_log_index_clear (GpkLogIndex *log_index)
+{
+	g_return_if_fail (GPK_IS_LOG_INDEX (log_index));
+	g_array_set_size (log_index->roles, 0);
+	g_array_set_size (log_index->timestamps, 0);
+	g_array_set_size (log_index->uids, 0);
+	g_array_set_size (log_index->succeeded, 0);
+	g_array_set_size (log_index->spans, 0);
+	g_string_truncate (log_index->text, 0);
+}
+
+/**
+ * gpk_log_index_get_length:
+ **/
+guint
+gpk_log_index_get_length (GpkLogIndex *log_index)
+{
+	g_return_val_if_fail (GPK_IS_LOG_INDEX (log_index), 0);
+	return log_index->spans->len;
+}
+
+/**
+ * gpk_log_index_get_role:
+ **/
+PkRoleEnum
+gpk_log_index_get_role (GpkLogIndex *log_index, guint idx)
+{
+	g_return_val_if_fail (GPK_IS_LOG_INDEX (log_index), PK_ROLE_ENUM_UNKNOWN);
+	g_return_val_if_fail (idx < log_index->roles->len, PK_ROLE_ENUM_UNKNOWN);
+	return g_array_index (log_index->roles, guint8, idx);
+}
+
+/**
+ * gpk_log_index_get_timestamp:
+ *
+ * Return value: the time of the transaction in seconds since the epoch
+ **/
+gint64
+gpk_log_index_get_timestamp (GpkLogIndex *log_index, guint idx)
+{
+	g_return_val_if_fail (GPK_IS_LOG_INDEX (log_index), 0);
+	g_return_val_if_fail (idx < log_index->timestamps->len, 0);
+	return g_array_index (log_index->timestamps, gint64, idx);
+}
+
+/**
+ * gpk_log_index_get_uid:
+ **/
+guint
+gpk_log_index_get_uid (GpkLogIndex *log_index, guint idx)
+{
+	g_return_val_if_fail (GPK_IS_LOG_INDEX (log_index), 0);
+	g_return_val_if_fail (idx < log_index->uids->len, 0);
+	return g_array_index (log_index->uids, guint, idx);
+}
+
+/**
+ * gpk_log_index_get_succeeded:
+ **/
+gboolean
+gpk_log_index_get_succeeded (GpkLogIndex *log_index, guint idx)
+{
+	g_return_val_if_fail (GPK_IS_LOG_INDEX (log_index), FALSE);
+	g_return_val_if_fail (idx < log_index->succeeded->len, FALSE);
+	return g_array_index (log_index->succeeded, guint8, idx);
+}
+
+/**
+ * gpk_log_index_get_cmdline:
+ **/
+const gchar *
+gpk_log_index_get_cmdline (GpkLogIndex *log_index, guint idx)
+{
+	g_return_val_if_fail (GPK_IS_LOG_INDEX (log_index), NULL);
+	g_return_val_if_fail (idx < log_index->spans->len, NULL);
+	return log_index->text->str + g_array_index (log_index->spans, GpkLogIndexSpan, idx).start;
+}
+
+static const gchar *
+gpk_log_index_find (const gchar *haystack, const gchar *end,
+		    const gchar *needle, gsize needle_len)
+{
+	const gchar *tmp;
+
+	/* memchr() is vectorised by the C library, so use it to skip to
+	 * each possible start rather than comparing byte by byte */
+	for (tmp = haystack; end - tmp >= (gssize) needle_len; tmp++) {
+		tmp = memchr (tmp, needle[0], end - tmp - needle_len + 1);
+		if (tmp == NULL)
+			return NULL;
+		if (memcmp (tmp, needle, needle_len) == 0)
+			return tmp;
+	}
+	return NULL;
+}
+
+/**
+ * gpk_log_index_search:
+ * @filter: the text to look for, or %NULL for all
+ * @matches: (element-type guint): set to the index of each transaction
+ * that succeeded and matches @filter, in order
+ *
+ * The fields are matched in the same way as gpk-log always has, so
+ * @filter can be in the command line, or the info type, name, version or
+ * arch of any package.
+ **/
+void
+gpk_log_index_search (GpkLogIndex *log_index, const gchar *filter, GArray *matches)
+{
+	const GpkLogIndexSpan *span;
+	const gchar *hit;
+	const gchar *pos;
+	const gchar *end;
+	gsize filter_len;
+	guint i = 0;
+
+	g_return_if_fail (GPK_IS_LOG_INDEX (log_index));
+
+	g_array_set_size (matches, 0);
+	filter_len = filter != NULL ? strlen (filter) : 0;
+	if (filter_len == 0) {
+		for (i = 0; i < log_index->spans->len; i++) {
+			if (g_array_index (log_index->succeeded, guint8, i))
+				g_array_append_val (matches, i);
+		}
+		return;
+	}
+
+	/* one pass over all the text, moving on to the next transaction
+	 * after each match; fields are NUL terminated so a match can never
+	 * run into the next one */
+	pos = log_index->text->str;
+	end = log_index->text->str + log_index->text->len;
+	while (i < log_index->spans->len) {
+		hit = gpk_log_index_find (pos, end, filter, filter_len);
+		if (hit == NULL)
+			break;
+
+		/* find the transaction the match is in */
+		while (log_index->text->str + g_array_index (log_index->spans, GpkLogIndexSpan, i).end <= hit)
+			i++;
+		span = &g_array_index (log_index->spans, GpkLogIndexSpan, i);
+		if (g_array_index (log_index->succeeded, guint8, i))
+			g_array_append_val (matches, i);
+		pos = log_index->text->str + span->end;
+		i++;
+	}
+}
+
+static void
+gpk_log_index_finalize (GObject *object)
+{
+	GpkLogIndex *log_index = GPK_LOG_INDEX (object);
+
+	g_array_unref (log_index->roles);
+	g_array_unref (log_index->timestamps);
+	g_array_unref (log_index->uids);
+	g_array_unref (log_index->succeeded);
+	g_array_unref (log_index->spans);
+	g_string_free (log_index->text, TRUE);
+
+	G_OBJECT_CLASS (gpk_log_index_parent_class)->finalize (object);
+}
+
+static void
+gpk_log_index_class_init (GpkLogIndexClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	object_class->finalize = gpk_log_index_finalize;
+}
+
+static void
+gpk_log_index_init (GpkLogIndex *log_index)
+{
+	log_index->roles = g_array_new (FALSE, FALSE, sizeof (guint8));
+	log_index->timestamps = g_array_new (FALSE, FALSE, sizeof (gint64));
+	log_index->uids = g_array_new (FALSE, FALSE, sizeof (guint));
+	log_index->succeeded = g_array_new (FALSE, FALSE, sizeof (guint8));
+	log_index->spans = g_array_new (FALSE, FALSE, sizeof (GpkLogIndexSpan));
+	log_index->text = g_string_new (NULL);
+}
+
+/**
+ * gpk_log_index_new:
+ **/
+GpkLogIndex *
+gpk_log_index_new (void)
+{
+	return g_object_new (GPK_TYPE_LOG_INDEX, NULL);
+}
@@ -0,0 +1,55 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef GPK_LOG_INDEX_H
+#define GPK_LOG_INDEX_H
+
+#include <glib-object.h>
+#include <packagekit-glib2/packagekit.h>
+
+G_BEGIN_DECLS
+
+#define GPK_TYPE_LOG_INDEX (gpk_log_index_get_type())
+G_DECLARE_FINAL_TYPE (GpkLogIndex, gpk_log_index, GPK, LOG_INDEX, GObject)
+
+GType		 gpk_log_index_get_type		(void);
+GpkLogIndex	*gpk_log_index_new		(void);
+void		 gpk_log_index_add		(GpkLogIndex	*log_index,
+						 PkTransactionPast *item);
+void		 gpk_log_index_clear		(GpkLogIndex	*log_index);
+guint		 gpk_log_index_get_length	(GpkLogIndex	*log_index);
+PkRoleEnum	 gpk_log_index_get_role		(GpkLogIndex	*log_index,
+						 guint		 idx);
+gint64		 gpk_log_index_get_timestamp	(GpkLogIndex	*log_index,
+						 guint		 idx);
+guint		 gpk_log_index_get_uid		(GpkLogIndex	*log_index,
+						 guint		 idx);
+gboolean	 gpk_log_index_get_succeeded	(GpkLogIndex	*log_index,
+						 guint		 idx);
+const gchar	*gpk_log_index_get_cmdline	(GpkLogIndex	*log_index,
+						 guint		 idx);
+void		 gpk_log_index_search		(GpkLogIndex	*log_index,
+						 const gchar	*filter,
+						 GArray		*matches);
+
+G_END_DECLS
+
+#endif /* GPK_LOG_INDEX_H */
@@ -28,11 +28,13 @@
 #include <locale.h>
 #include <sys/types.h>
 #include <pwd.h>
+#include <unistd.h>
 
 #include <packagekit-glib2/packagekit.h>
 
 #include "gpk-common.h"
 #include "gpk-debug.h"
+#include "gpk-log-index.h"
 
 static GtkBuilder *builder = NULL;
 static GtkListStore *list_store = NULL;
@@ -40,8 +42,24 @@ static PkClient *client = NULL;
 static gchar *transaction_id = NULL;
 static gchar *filter = NULL;
 static GPtrArray *transactions = NULL;
-static GtkTreePath *path_global = NULL;
+static GpkLogIndex *log_index = NULL;
+static GtkTreeModel *filter_model = NULL;
+static GArray *visible = NULL;		/* of guint8, by transaction */
+static GArray *matches = NULL;		/* of guint */
 static guint xid = 0;
+static guint history_limit = 0;
+static gboolean history_complete = FALSE;
+static gboolean history_loading = FALSE;
+static GHashTable *user_names = NULL;	/* uid:name, NULL while resolving */
+static guint user_names_hits = 0;
+static guint user_names_misses = 0;
+static GHashTable *tool_names = NULL;	/* cmdline:tool */
+static guint tool_names_hits = 0;
+static guint tool_names_misses = 0;
+
+/* the daemon only returns the newest transactions, so each page asks for
+ * twice as many as the last to keep the total work linear */
+#define GPK_LOG_HISTORY_PAGE	200
 
 enum
 {
@@ -54,74 +72,11 @@ enum
 	GPK_LOG_COLUMN_ID,
 	GPK_LOG_COLUMN_USER,
 	GPK_LOG_COLUMN_TOOL,
-	GPK_LOG_COLUMN_ACTIVE,
+	GPK_LOG_COLUMN_INDEX,
+	GPK_LOG_COLUMN_UID,
 	GPK_LOG_COLUMN_LAST
 };
 
-static gboolean
-gpk_log_find_iter_model_cb (GtkTreeModel *model, GtkTreePath *path, GtkTreeIter *iter, const gchar *id)
-{
-	gchar *id_tmp = NULL;
-	gtk_tree_model_get (model, iter, GPK_LOG_COLUMN_ID, &id_tmp, -1);
-	if (strcmp (id_tmp, id) == 0) {
-		path_global = gtk_tree_path_copy (path);
-		return TRUE;
-	}
-	return FALSE;
-}
-
-static gboolean
-gpk_log_mark_nonactive_cb (GtkTreeModel *model, GtkTreePath *path, GtkTreeIter *iter, gpointer data)
-{
-	gtk_list_store_set (GTK_LIST_STORE(model), iter, GPK_LOG_COLUMN_ACTIVE, FALSE, -1);
-	return FALSE;
-}
-
-static void
-gpk_log_mark_nonactive (GtkTreeModel *model)
-{
-	gtk_tree_model_foreach (model, (GtkTreeModelForeachFunc) gpk_log_mark_nonactive_cb, NULL);
-}
-
-static gboolean
-gpk_log_remove_nonactive_cb (GtkTreeModel *model, GtkTreePath *path, GtkTreeIter *iter, gboolean *ret)
-{
-	gboolean active;
-	gtk_tree_model_get (model, iter, GPK_LOG_COLUMN_ACTIVE, &active, -1);
-	if (!active) {
-		*ret = TRUE;
-		gtk_list_store_remove (GTK_LIST_STORE(model), iter);
-		return TRUE;
-	}
-	return FALSE;
-}
-
-static void
-gpk_log_remove_nonactive (GtkTreeModel *model)
-{
-	gboolean ret;
-	/* do this again and again as removing in gtk_tree_model_foreach causes errors */
-	do {
-		ret = FALSE;
-		gtk_tree_model_foreach (model, (GtkTreeModelForeachFunc) gpk_log_remove_nonactive_cb, &ret);
-	} while (ret);
-}
-
-static gboolean
-gpk_log_model_get_iter (GtkTreeModel *model, GtkTreeIter *iter, const gchar *id)
-{
-	gboolean ret = TRUE;
-	path_global = NULL;
-	gtk_tree_model_foreach (model, (GtkTreeModelForeachFunc) gpk_log_find_iter_model_cb, (gpointer) id);
-	if (path_global == NULL) {
-		gtk_list_store_append (GTK_LIST_STORE(model), iter);
-	} else {
-		ret = gtk_tree_model_get_iter (model, iter, path_global);
-		gtk_tree_path_free (path_global);
-	}
-	return ret;
-}
-
 static gchar *
 gpk_log_get_localised_date (const gchar *timespec)
 {
@@ -143,71 +98,89 @@ gpk_log_get_localised_date (const gchar *timespec)
 	return g_strdup (buffer);
 }
 
-static gchar *
-gpk_log_get_type_line (gchar **array, PkInfoEnum info)
-{
-	guint i;
-	guint size;
-	PkInfoEnum info_local;
-	const gchar *info_text;
-	GString *string;
-	g_autofree gchar *text = NULL;
-	gchar *whole;
-
-	string = g_string_new ("");
-	size = g_strv_length (array);
-	info_text = gpk_info_enum_to_localised_past (info);
-
-	/* find all of this type */
-	for (i = 0; i < size; i++) {
-		g_auto(GStrv) sections = NULL;
-		sections = g_strsplit (array[i], "\t", 0);
-		info_local = pk_info_enum_from_string (sections[0]);
-		if (info_local == info) {
-			g_autofree gchar *str = NULL;
-			str = gpk_package_id_format_oneline (sections[1], NULL);
-			g_string_append_printf (string, "%s, ", str);
-		}
-	}
-
-	/* nothing, so return NULL */
-	if (string->len == 0) {
-		g_string_free (string, TRUE);
-		return NULL;
-	}
+/* the order the sections are shown in */
+static const PkInfoEnum gpk_log_details_order[] = {
+	PK_INFO_ENUM_INSTALLING,
+	PK_INFO_ENUM_REMOVING,
+	PK_INFO_ENUM_UPDATING,
+	PK_INFO_ENUM_REINSTALLING,
+	PK_INFO_ENUM_DOWNGRADING,
+	PK_INFO_ENUM_OBSOLETING,
+	PK_INFO_ENUM_CLEANUP,
+	PK_INFO_ENUM_DOWNLOADING,
+	PK_INFO_ENUM_PREPARING,
+	PK_INFO_ENUM_DECOMPRESSING,
+};
 
-	/* remove last comma space */
-	g_string_set_size (string, string->len - 2);
-
-	/* add a nice header, and make text italic */
-	text = g_string_free (string, FALSE);
-	whole = g_strdup_printf ("<b>%s</b>: %s\n", info_text, text);
-	return whole;
-}
+typedef struct {
+	PkInfoEnum	 info;
+	const gchar	*name;
+	guint		 len;
+} GpkLogDetailsEntry;
 
 static gchar *
 gpk_log_get_details_localised (const gchar *timespec, const gchar *data)
 {
+	GpkLogDetailsEntry entry;
+	GpkLogDetailsEntry *tmp;
+	GpkPackageIdView view;
 	GString *string;
-	gchar *text;
-	g_auto(GStrv) array = NULL;
+	gchar *line;
+	gchar *next;
+	gchar *package_id;
+	gchar *summary;
+	guint counts[PK_INFO_ENUM_LAST] = { 0 };
+	guint i;
+	guint j;
+	guint done;
+	g_autofree gchar *buf = NULL;
+	g_autoptr(GArray) entries = NULL;
+
+	/* split each "info\tpackage_id\tsummary" line in place, just once */
+	entries = g_array_new (FALSE, FALSE, sizeof (GpkLogDetailsEntry));
+	buf = g_strdup (data != NULL ? data : "");
+	for (line = buf; *line != '\0'; line = next) {
+		next = strchr (line, '\n');
+		if (next != NULL)
+			*next++ = '\0';
+		else
+			next = line + strlen (line);
+		package_id = strchr (line, '\t');
+		if (package_id == NULL)
+			continue;
+		*package_id++ = '\0';
+		summary = strchr (package_id, '\t');
+		if (summary != NULL)
+			*summary = '\0';
+
+		entry.info = pk_info_enum_from_string (line);
+		if ((guint) entry.info >= PK_INFO_ENUM_LAST)
+			continue;
+		if (!gpk_package_id_view_parse (&view, package_id))
+			continue;
+		entry.name = gpk_package_id_view_get (&view, PK_PACKAGE_ID_NAME, &entry.len);
+		g_array_append_val (entries, entry);
+		counts[entry.info]++;
+	}
 
+	/* one section for each type, e.g. "<b>Installed</b>: foo, bar" */
 	string = g_string_new ("");
-	array = g_strsplit (data, "\n", 0);
-
-	/* get each type */
-	text = gpk_log_get_type_line (array, PK_INFO_ENUM_INSTALLING);
-	if (text != NULL)
-		g_string_append (string, text);
-	g_free (text);
-	text = gpk_log_get_type_line (array, PK_INFO_ENUM_REMOVING);
-	if (text != NULL)
-		g_string_append (string, text);
-	g_free (text);
-	text = gpk_log_get_type_line (array, PK_INFO_ENUM_UPDATING);
-	if (text != NULL)
-		g_string_append (string, text);
-	g_free (text);
+	for (i = 0; i < G_N_ELEMENTS (gpk_log_details_order); i++) {
+		PkInfoEnum info = gpk_log_details_order[i];
+		if (counts[info] == 0)
+			continue;
+		g_string_append_printf (string, "<b>%s</b>: ",
+					gpk_info_enum_to_localised_past (info));
+		for (j = 0, done = 0; done < counts[info]; j++) {
+			tmp = &g_array_index (entries, GpkLogDetailsEntry, j);
+			if (tmp->info != info)
+				continue;
+			if (done++ > 0)
+				g_string_append (string, ", ");
+			g_string_append_len (string, tmp->name, tmp->len);
+		}
+		g_string_append_c (string, '\n');
+	}
 
 	/* remove last \n */
 	if (string->len > 0)
@@ -314,78 +287,138 @@ gpk_log_treeview_clicked_cb (GtkTreeSelection *selection, gpointer data)
 }
 
 static gboolean
-gpk_log_filter (PkTransactionPast *item)
+gpk_log_update_user_cb (GtkTreeModel *model, GtkTreePath *path, GtkTreeIter *iter, gpointer user_data)
 {
-	gboolean ret = FALSE;
-	guint i;
-	guint length;
-	g_auto(GStrv) packages = NULL;
-	g_autofree gchar *tid = NULL;
-	gboolean succeeded;
-	g_autofree gchar *cmdline = NULL;
-	g_autofree gchar *data = NULL;
+	guint uid = GPOINTER_TO_UINT (user_data);
+	guint uid_tmp;
+
+	gtk_tree_model_get (model, iter, GPK_LOG_COLUMN_UID, &uid_tmp, -1);
+	if (uid_tmp == uid) {
+		gtk_list_store_set (GTK_LIST_STORE (model), iter,
+				    GPK_LOG_COLUMN_USER, g_hash_table_lookup (user_names, user_data),
+				    -1);
+	}
+	return FALSE;
+}
 
-	/* get data */
-	g_object_get (item,
-		      "tid", &tid,
-		      "succeeded", &succeeded,
-		      "cmdline", &cmdline,
-		      "data", &data,
-		      NULL);
+static void
+gpk_log_user_name_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	gchar *name;
 
-	/* only show transactions that succeeded */
-	if (!succeeded) {
-		g_debug ("tid %s did not succeed, so not adding", tid);
-		return FALSE;
+	/* unknown users are cached too, so they are only looked up once */
+	name = g_task_propagate_pointer (G_TASK (res), NULL);
+	if (name == NULL)
+		name = g_strdup ("");
+	g_hash_table_insert (user_names, user_data, name);
+
+	/* fill in the rows that were added while resolving */
+	gtk_tree_model_foreach (GTK_TREE_MODEL (list_store),
+				gpk_log_update_user_cb, user_data);
+}
+
+static void
+gpk_log_user_name_thread_cb (GTask *task, gpointer source_object,
+			     gpointer task_data, GCancellable *cancellable)
+{
+	struct passwd pwbuf;
+	struct passwd *pw = NULL;
+	glong bufsize;
+	g_autofree gchar *buf = NULL;
+
+	/* getpwuid() is not thread safe */
+	bufsize = sysconf (_SC_GETPW_R_SIZE_MAX);
+	if (bufsize <= 0)
+		bufsize = 16384;
+	buf = g_malloc (bufsize);
+	if (getpwuid_r (GPOINTER_TO_UINT (task_data), &pwbuf, buf, bufsize, &pw) != 0 ||
+	    pw == NULL) {
+		g_task_return_pointer (task, NULL, NULL);
+		return;
 	}
 
-	if (filter == NULL)
-		return TRUE;
-
-	/* matches cmdline */
-	if (cmdline != NULL && g_strrstr (cmdline, filter) != NULL)
-		ret = TRUE;
-
-	/* look in all the data for the filter string */
-	packages = g_strsplit (data, "\n", 0);
-	length = g_strv_length (packages);
-	for (i = 0; i < length; i++) {
-		g_auto(GStrv) split = NULL;
-		g_auto(GStrv) sections = NULL;
-		sections = g_strsplit (packages[i], "\t", 0);
-
-		/* check if type matches filter */
-		if (g_strrstr (sections[0], filter) != NULL)
-			ret = TRUE;
-
-		/* check to see if package name, version or arch matches */
-		split = pk_package_id_split (sections[1]);
-		if (g_strrstr (split[0], filter) != NULL)
-			ret = TRUE;
-		if (split[1] != NULL && g_strrstr (split[1], filter) != NULL)
-			ret = TRUE;
-		if (split[2] != NULL && g_strrstr (split[2], filter) != NULL)
-			ret = TRUE;
-
-		/* shortcut for speed */
-		if (ret)
-			break;
+	/* prefer the real name */
+	if (pw->pw_gecos != NULL && pw->pw_gecos[0] != '\0')
+		g_task_return_pointer (task, g_strdup (pw->pw_gecos), g_free);
+	else
+		g_task_return_pointer (task, g_strdup (pw->pw_name), g_free);
+}
+
+static const gchar *
+gpk_log_get_user_name (guint uid)
+{
+	gpointer name;
+	g_autoptr(GTask) task = NULL;
+
+	if (g_hash_table_lookup_extended (user_names, GUINT_TO_POINTER (uid), NULL, &name)) {
+		user_names_hits++;
+		return name;
 	}
-	return ret;
+	user_names_misses++;
+
+	/* with NSS this can be a network lookup, so do it in a thread */
+	g_hash_table_insert (user_names, GUINT_TO_POINTER (uid), NULL);
+	task = g_task_new (NULL, NULL, gpk_log_user_name_cb, GUINT_TO_POINTER (uid));
+	g_task_set_task_data (task, GUINT_TO_POINTER (uid), NULL);
+	g_task_run_in_thread (task, gpk_log_user_name_thread_cb);
+	return NULL;
+}
+
+static const gchar *
+gpk_log_get_tool_name (const gchar *cmdline)
+{
+	const gchar *tool;
+	gchar *key;
+
+	if (cmdline == NULL)
+		cmdline = "";
+	tool = g_hash_table_lookup (tool_names, cmdline);
+	if (tool != NULL) {
+		tool_names_hits++;
+		return tool;
+	}
+	tool_names_misses++;
+
+	/* get nice name for tool name */
+	key = g_strdup (cmdline);
+	if (strstr (cmdline, "pkcon") != NULL)
+		/* TRANSLATORS: user-friendly name for pkcon */
+		tool = _("Command line client");
+	else if (strstr (cmdline, "gpk-application") != NULL)
+		/* TRANSLATORS: user-friendly name for gpk-update-viewer */
+		tool = _("GNOME Packages");
+	else if (strstr (cmdline, "gpk-update-viewer") != NULL)
+		/* TRANSLATORS: user-friendly name for gpk-update-viewer */
+		tool = _("GNOME Package Updater");
+	else if (strstr (cmdline, "gpk-update-icon") != NULL)
+		/* TRANSLATORS: user-friendly name for gpk-update-icon, which used to exist */
+		tool = _("Update Icon");
+	else if (strstr (cmdline, "pk-command-not-found") != NULL)
+		/* TRANSLATORS: user-friendly name for the command not found plugin */
+		tool = _("Bash – Command Not Found");
+	else if (strstr (cmdline, "gnome-settings-daemon") != NULL)
+		/* TRANSLATORS: user-friendly name for gnome-settings-daemon, which used to handle updates */
+		tool = _("GNOME Session");
+	else if (strstr (cmdline, "gnome-software") != NULL)
+		/* TRANSLATORS: user-friendly name for gnome-software */
+		tool = _("GNOME Software");
+	else
+		tool = key;
+
+	g_hash_table_insert (tool_names, key, (gpointer) tool);
+	return tool;
 }
 
 static void
-gpk_log_add_item (PkTransactionPast *item)
+gpk_log_add_item (PkTransactionPast *item, guint idx)
 {
-	GtkTreeIter iter;
 	g_autofree gchar *details = NULL;
 	g_autofree gchar *date = NULL;
 	const gchar *icon_name;
 	const gchar *role_text;
-	const gchar *username = NULL;
+	const gchar *username;
 	const gchar *tool;
 	static guint count;
-	struct passwd *pw;
 	g_autofree gchar *tid = NULL;
 	g_autofree gchar *timespec = NULL;
 	gboolean succeeded;
@@ -394,8 +427,6 @@ gpk_log_add_item (PkTransactionPast *item)
 	guint uid;
 	g_autofree gchar *data = NULL;
 	PkRoleEnum role;
-	GtkTreeView *treeview = GTK_TREE_VIEW (gtk_builder_get_object (builder, "treeview_simple"));
-	GtkTreeModel *model = gtk_tree_view_get_model (treeview);
 
 	/* get data */
 	g_object_get (item,
@@ -416,52 +447,23 @@ gpk_log_add_item (PkTransactionPast *item)
 	icon_name = gpk_role_enum_to_icon_name (role);
 	role_text = gpk_role_enum_to_localised_past (role);
 
-	/* query real name */
-	pw = getpwuid(uid);
-	if (pw != NULL) {
-		if (pw->pw_gecos != NULL)
-			username = pw->pw_gecos;
-		else if (pw->pw_name != NULL)
-			username = pw->pw_name;
-	}
-
-	/* get nice name for tool name */
-	if (strstr (cmdline, "pkcon") != NULL)
-		/* TRANSLATORS: user-friendly name for pkcon */
-		tool = _("Command line client");
-	else if (strstr (cmdline, "gpk-application") != NULL)
-		/* TRANSLATORS: user-friendly name for gpk-update-viewer */
-		tool = _("GNOME Packages");
-	else if (strstr (cmdline, "gpk-update-viewer") != NULL)
-		/* TRANSLATORS: user-friendly name for gpk-update-viewer */
-		tool = _("GNOME Package Updater");
-	else if (strstr (cmdline, "gpk-update-icon") != NULL)
-		/* TRANSLATORS: user-friendly name for gpk-update-icon, which used to exist */
-		tool = _("Update Icon");
-	else if (strstr (cmdline, "pk-command-not-found") != NULL)
-		/* TRANSLATORS: user-friendly name for the command not found plugin */
-		tool = _("Bash – Command Not Found");
-	else if (strstr (cmdline, "gnome-settings-daemon") != NULL)
-		/* TRANSLATORS: user-friendly name for gnome-settings-daemon, which used to handle updates */
-		tool = _("GNOME Session");
-	else if (strstr (cmdline, "gnome-software") != NULL)
-		/* TRANSLATORS: user-friendly name for gnome-software */
-		tool = _("GNOME Software");
-	else
-		tool = cmdline;
-
-	gpk_log_model_get_iter (model, &iter, tid);
-	gtk_list_store_set (list_store, &iter,
-			    GPK_LOG_COLUMN_ICON, icon_name,
-			    GPK_LOG_COLUMN_TIMESPEC, timespec,
-			    GPK_LOG_COLUMN_DATE_TEXT, date,
-			    GPK_LOG_COLUMN_DATE, timespec,
-			    GPK_LOG_COLUMN_ROLE, role_text,
-			    GPK_LOG_COLUMN_DETAILS, details,
-			    GPK_LOG_COLUMN_ID, tid,
-			    GPK_LOG_COLUMN_USER, username,
-			    GPK_LOG_COLUMN_TOOL, tool,
-			    GPK_LOG_COLUMN_ACTIVE, TRUE, -1);
+	/* both are cached, and the name may be filled in later */
+	username = gpk_log_get_user_name (uid);
+	tool = gpk_log_get_tool_name (cmdline);
+
+	/* set all at once so the filter only sees the finished row */
+	gtk_list_store_insert_with_values (list_store, NULL, -1,
+					   GPK_LOG_COLUMN_ICON, icon_name,
+					   GPK_LOG_COLUMN_TIMESPEC, timespec,
+					   GPK_LOG_COLUMN_DATE_TEXT, date,
+					   GPK_LOG_COLUMN_DATE, timespec,
+					   GPK_LOG_COLUMN_ROLE, role_text,
+					   GPK_LOG_COLUMN_DETAILS, details,
+					   GPK_LOG_COLUMN_ID, tid,
+					   GPK_LOG_COLUMN_USER, username,
+					   GPK_LOG_COLUMN_TOOL, tool,
+					   GPK_LOG_COLUMN_INDEX, idx,
+					   GPK_LOG_COLUMN_UID, uid, -1);
 
 	/* spin the gui */
 	if (count++ % 10 == 0)
@@ -469,16 +471,50 @@ gpk_log_add_item (PkTransactionPast *item)
 			gtk_main_iteration ();
 }
 
+static void gpk_log_fetch_more (void);
+static void gpk_log_adjustment_cb (GtkAdjustment *adjustment, gpointer user_data);
+
 static void
-gpk_log_refilter (void)
+gpk_log_add_rows (guint start)
 {
 	guint i;
-	gboolean ret;
-	PkTransactionPast *item;
+
+	/* each transaction that succeeded gets a row, formatted once */
+	for (i = start; i < transactions->len; i++) {
+		if (!gpk_log_index_get_succeeded (log_index, i))
+			continue;
+		gpk_log_add_item (g_ptr_array_index (transactions, i), i);
+	}
+}
+
+static gboolean
+gpk_log_visible_func (GtkTreeModel *model, GtkTreeIter *iter, gpointer user_data)
+{
+	guint idx;
+
+	gtk_tree_model_get (model, iter, GPK_LOG_COLUMN_INDEX, &idx, -1);
+	return idx < visible->len && g_array_index (visible, guint8, idx);
+}
+
+static void
+gpk_log_update_visible (void)
+{
+	guint i;
+
+	/* the arrays are reused, so typing does not allocate; the visible
+	 * array is cleared to zero when grown */
+	g_array_set_size (visible, 0);
+	g_array_set_size (visible, gpk_log_index_get_length (log_index));
+	gpk_log_index_search (log_index, filter, matches);
+	for (i = 0; i < matches->len; i++)
+		g_array_index (visible, guint8, g_array_index (matches, guint, i)) = TRUE;
+}
+
+static void
+gpk_log_refilter (void)
+{
 	GtkWidget *widget;
 	const gchar *package;
-	GtkTreeView *treeview;
-	GtkTreeModel *model;
 
 	/* set the new filter */
 	g_free (filter);
@@ -489,23 +525,32 @@ gpk_log_refilter (void)
 	else
 		filter = NULL;
 
+	/* not got the first page yet */
+	if (transactions == NULL)
+		return;
+
 	g_debug ("len=%i", transactions->len);
 
-	/* mark the items as not used */
-	treeview = GTK_TREE_VIEW (gtk_builder_get_object (builder, "treeview_simple"));
-	model = gtk_tree_view_get_model (treeview);
-	gpk_log_mark_nonactive (model);
-
-	/* go through the list, adding and removing the items as required */
-	for (i = 0; i < transactions->len; i++) {
-		item = g_ptr_array_index (transactions, i);
-		ret = gpk_log_filter (item);
-		if (ret)
-			gpk_log_add_item (item);
-	}
+	/* the rows are all there already, so just show and hide them */
+	gpk_log_update_visible ();
+	gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (filter_model));
 
-	/* remove the items that are not used */
-	gpk_log_remove_nonactive (model);
+	/* searching needs all of the history */
+	if (filter != NULL)
+		gpk_log_fetch_more ();
+}
+
+static gboolean
+gpk_log_transactions_is_prefix (GPtrArray *array_old, GPtrArray *array)
+{
+	g_autofree gchar *tid_old = NULL;
+	g_autofree gchar *tid = NULL;
+
+	if (array_old == NULL || array_old->len == 0 || array_old->len > array->len)
+		return FALSE;
+	g_object_get (g_ptr_array_index (array_old, array_old->len - 1), "tid", &tid_old, NULL);
+	g_object_get (g_ptr_array_index (array, array_old->len - 1), "tid", &tid, NULL);
+	return g_strcmp0 (tid_old, tid) == 0;
 }
 
 static void
@@ -513,13 +558,18 @@ gpk_log_get_old_transactions_cb (GObject *object, GAsyncResult *res, gpointer us
 {
 //	PkClient *client = PK_CLIENT (object);
 	g_autoptr(GError) error = NULL;
-	PkResults *results = NULL;
+	g_autoptr(PkResults) results = NULL;
 	g_autoptr(PkError) error_code = NULL;
+	g_autoptr(GPtrArray) array = NULL;
+	GtkWidget *widget;
+	guint i;
+	guint start = 0;
 
 	/* get the results */
 	results = pk_client_generic_finish (client, res, &error);
 	if (results == NULL) {
 		g_warning ("failed to get old transactions: %s", error->message);
+		history_loading = FALSE;
 		return;
 	}
 
@@ -527,24 +577,89 @@ gpk_log_get_old_transactions_cb (GObject *object, GAsyncResult *res, gpointer us
 	error_code = pk_results_get_error_code (results);
 	if (error_code != NULL) {
 		g_warning ("failed to get old transactions: %s, %s", pk_error_enum_to_string (pk_error_get_code (error_code)), pk_error_get_details (error_code));
+		history_loading = FALSE;
 		return;
 	}
 
-	/* get the list */
+	/* fewer than we asked for means there is no older history */
+	array = pk_results_get_transaction_array (results);
+	history_complete = array->len < history_limit;
+	g_debug ("got %u of %u transactions", array->len, history_limit);
+
+	/* the newest come first, so unless something has happened since
+	 * the last page only the older transactions on the end are new */
+	if (gpk_log_transactions_is_prefix (transactions, array)) {
+		start = transactions->len;
+	} else {
+		gpk_log_index_clear (log_index);
+		gtk_list_store_clear (list_store);
+	}
+
+	/* parse the data once, rather than on every keypress */
+	for (i = start; i < array->len; i++)
+		gpk_log_index_add (log_index, g_ptr_array_index (array, i));
 	if (transactions != NULL)
 		g_ptr_array_unref (transactions);
-	transactions = pk_results_get_transaction_array (results);
-	gpk_log_refilter ();
+	transactions = g_ptr_array_ref (array);
+
+	/* adding the rows spins the mainloop, so do not start another page
+	 * until this one is done */
+	gpk_log_update_visible ();
+	gpk_log_add_rows (start);
+	history_loading = FALSE;
+
+	/* searching needs all of the history */
+	if (filter != NULL) {
+		gpk_log_fetch_more ();
+		return;
+	}
+
+	/* the user may be waiting at the bottom already */
+	widget = GTK_WIDGET (gtk_builder_get_object (builder, "scrolledwindow_simple"));
+	gpk_log_adjustment_cb (gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (widget)), NULL);
 }
 
 static void
-gpk_log_refresh (void)
+gpk_log_get_old_transactions (void)
 {
-	/* get the list async */
-	pk_client_get_old_transactions_async (client, 0, NULL, NULL, NULL,
+	history_loading = TRUE;
+	pk_client_get_old_transactions_async (client, history_limit, NULL, NULL, NULL,
 					      (GAsyncReadyCallback) gpk_log_get_old_transactions_cb, NULL);
 }
 
+static void
+gpk_log_fetch_more (void)
+{
+	/* the first page sets the size of the next */
+	if (transactions == NULL)
+		return;
+	if (history_complete || history_loading)
+		return;
+	history_limit *= 2;
+	gpk_log_get_old_transactions ();
+}
+
+static void
+gpk_log_refresh (void)
+{
+	/* get the newest page async, older ones are fetched as needed */
+	history_limit = GPK_LOG_HISTORY_PAGE;
+	history_complete = FALSE;
+	gpk_log_get_old_transactions ();
+}
+
+static void
+gpk_log_adjustment_cb (GtkAdjustment *adjustment, gpointer user_data)
+{
+	gdouble page_size = gtk_adjustment_get_page_size (adjustment);
+
+	/* get more when there is less than a page left to scroll */
+	if (gtk_adjustment_get_value (adjustment) + 2 * page_size <
+	    gtk_adjustment_get_upper (adjustment))
+		return;
+	gpk_log_fetch_more ();
+}
+
 static void
 gpk_log_button_refresh_cb (GtkWidget *widget, gpointer data)
 {
@@ -581,8 +696,13 @@ gpk_log_startup_cb (GtkApplication *application, gpointer user_data)
 	GtkWidget *widget;
 	GtkWindow *window;
 	guint retval;
+	GtkAdjustment *adjustment;
+	g_autoptr(GtkTreeModel) sort_model = NULL;
 
 	client = pk_client_new ();
+	log_index = gpk_log_index_new ();
+	user_names = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+	tool_names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 	g_object_set (client,
 		      "background", FALSE,
 		      NULL);
@@ -594,7 +714,7 @@ gpk_log_startup_cb (GtkApplication *application, gpointer user_data)
 						&error);
 	if (retval == 0) {
 		g_warning ("failed to load ui: %s", error->message);
-		goto out;
+		return;
 	}
 
 	window = GTK_WINDOW (gtk_builder_get_object (builder, "dialog_simple"));
@@ -626,12 +746,21 @@ gpk_log_startup_cb (GtkApplication *application, gpointer user_data)
 	/* create list stores */
 	list_store = gtk_list_store_new (GPK_LOG_COLUMN_LAST, G_TYPE_STRING, G_TYPE_STRING,
 					 G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING,
-					 G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_BOOLEAN);
+					 G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_UINT,
+					 G_TYPE_UINT);
+
+	/* filtering hides rows rather than removing them, and the filter
+	 * model cannot be sorted itself */
+	visible = g_array_new (FALSE, TRUE, sizeof (guint8));
+	matches = g_array_new (FALSE, FALSE, sizeof (guint));
+	filter_model = gtk_tree_model_filter_new (GTK_TREE_MODEL (list_store), NULL);
+	gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (filter_model),
+						gpk_log_visible_func, NULL, NULL);
+	sort_model = gtk_tree_model_sort_new_with_model (filter_model);
 
 	/* create transaction_id tree view */
 	widget = GTK_WIDGET (gtk_builder_get_object (builder, "treeview_simple"));
-	gtk_tree_view_set_model (GTK_TREE_VIEW (widget),
-				 GTK_TREE_MODEL (list_store));
+	gtk_tree_view_set_model (GTK_TREE_VIEW (widget), sort_model);
 
 	selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (widget));
 	g_signal_connect (selection, "changed",
@@ -641,9 +770,18 @@ gpk_log_startup_cb (GtkApplication *application, gpointer user_data)
 	pk_treeview_add_general_columns (GTK_TREE_VIEW (widget));
 	gtk_tree_view_columns_autosize (GTK_TREE_VIEW (widget));
 
-	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (list_store),
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model),
 					      GPK_LOG_COLUMN_TIMESPEC, GTK_SORT_DESCENDING);
 
+	/* get older history when scrolled to the bottom, or when the
+	 * newest page does not fill the window */
+	widget = GTK_WIDGET (gtk_builder_get_object (builder, "scrolledwindow_simple"));
+	adjustment = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (widget));
+	g_signal_connect (adjustment, "value-changed",
+			  G_CALLBACK (gpk_log_adjustment_cb), NULL);
+	g_signal_connect (adjustment, "changed",
+			  G_CALLBACK (gpk_log_adjustment_cb), NULL);
+
 	/* show */
 	widget = GTK_WIDGET (gtk_builder_get_object (builder, "dialog_simple"));
 	gtk_widget_show (widget);
@@ -656,13 +794,6 @@ gpk_log_startup_cb (GtkApplication *application, gpointer user_data)
 
 	/* get the update list */
 	gpk_log_refresh ();
-out:
-	g_object_unref (list_store);
-	g_object_unref (client);
-	g_free (transaction_id);
-	g_free (filter);
-	if (transactions != NULL)
-		g_ptr_array_unref (transactions);
 }
 
 int
@@ -720,5 +851,29 @@ main (int argc, char *argv[])
 out:
 	if (builder != NULL)
 		g_object_unref (builder);
+	if (filter_model != NULL)
+		g_object_unref (filter_model);
+	if (list_store != NULL)
+		g_object_unref (list_store);
+	if (visible != NULL)
+		g_array_unref (visible);
+	if (matches != NULL)
+		g_array_unref (matches);
+	if (client != NULL)
+		g_object_unref (client);
+	if (log_index != NULL)
+		g_object_unref (log_index);
+	if (user_names != NULL) {
+		gpk_debug_stats ("user", user_names_hits, user_names_misses);
+		g_hash_table_unref (user_names);
+	}
+	if (tool_names != NULL) {
+		gpk_debug_stats ("tool", tool_names_hits, tool_names_misses);
+		g_hash_table_unref (tool_names);
+	}
+	if (transactions != NULL)
+		g_ptr_array_unref (transactions);
+	g_free (transaction_id);
+	g_free (filter);
 	return status;
 }
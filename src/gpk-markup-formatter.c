@@ -0,0 +1,291 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <packagekit-glib2/packagekit.h>
+
+#include "gpk-common.h"
+#include "gpk-markup-formatter.h"
+
+/* rows formatted by each job on the pool */
+#define GPK_MARKUP_FORMATTER_CHUNK	256
+
+struct _GpkMarkupFormatter
+{
+	GObject			 parent_instance;
+	GtkWidget		*widget;
+	gchar			*color;
+	gulong			 style_updated_id;
+};
+
+G_DEFINE_TYPE (GpkMarkupFormatter, gpk_markup_formatter, G_TYPE_OBJECT)
+
+typedef struct {
+	GPtrArray		*packages;	/* of PkPackage */
+	GPtrArray		*markup;	/* of gchar*, same order */
+	gchar			*color;
+	gint			 pending;	/* jobs, atomic */
+} GpkMarkupFormatterBatch;
+
+typedef struct {
+	GTask			*task;
+	guint			 start;
+	guint			 end;
+} GpkMarkupFormatterJob;
+
+static void
+gpk_markup_formatter_batch_free (GpkMarkupFormatterBatch *batch)
+{
+	g_ptr_array_unref (batch->packages);
+	g_ptr_array_unref (batch->markup);
+	g_free (batch->color);
+	g_free (batch);
+}
+
+static void
+gpk_markup_formatter_thread_cb (gpointer data, gpointer user_data)
+{
+	GpkMarkupFormatterJob *job = data;
+	GpkMarkupFormatterBatch *batch = g_task_get_task_data (job->task);
+	GCancellable *cancellable;
+	PkPackage *package;
+	guint i;
+
+	/* each job writes only its own slots */
+	cancellable = g_task_get_cancellable (job->task);
+	for (i = job->start; i < job->end; i++) {
+		if (g_cancellable_is_cancelled (cancellable))
+			break;
+		package = g_ptr_array_index (batch->packages, i);
+		batch->markup->pdata[i] =
+			gpk_package_id_format_twoline_color (batch->color,
+							     pk_package_get_id (package),
+							     pk_package_get_summary (package));
+	}
+
+	/* the last job to finish returns the results */
+	if (g_atomic_int_dec_and_test (&batch->pending)) {
+		if (!g_task_return_error_if_cancelled (job->task))
+			g_task_return_pointer (job->task,
+					       g_ptr_array_ref (batch->markup),
+					       (GDestroyNotify) g_ptr_array_unref);
+	}
+	g_object_unref (job->task);
+	g_free (job);
+}
+
+static GThreadPool *
+gpk_markup_formatter_get_pool (void)
+{
+	static GThreadPool *pool = NULL;
+
+	/* shared by every formatter and never freed */
+	if (g_once_init_enter (&pool)) {
+		GThreadPool *tmp;
+		tmp = g_thread_pool_new (gpk_markup_formatter_thread_cb, NULL,
+					 MAX (g_get_num_processors () - 1, 1),
+					 FALSE, NULL);
+		g_once_init_leave (&pool, tmp);
+	}
+	return pool;
+}
+
+static void
+gpk_markup_formatter_update_color (GpkMarkupFormatter *formatter)
+{
+	g_free (formatter->color);
+	if (formatter->widget != NULL)
+		formatter->color = gpk_style_context_get_inactive_color (gtk_widget_get_style_context (formatter->widget));
+	else
+		formatter->color = gpk_style_context_get_inactive_color (NULL);
+}
+
+static void
+gpk_markup_formatter_style_updated_cb (GtkWidget *widget, GpkMarkupFormatter *formatter)
+{
+	gpk_markup_formatter_update_color (formatter);
+}
+
+static void
+gpk_markup_formatter_widget_destroyed_cb (gpointer data, GObject *where_the_object_was)
+{
+	GpkMarkupFormatter *formatter = GPK_MARKUP_FORMATTER (data);
+	formatter->widget = NULL;
+	formatter->style_updated_id = 0;
+}
+
+static void
+gpk_markup_formatter_unset_widget (GpkMarkupFormatter *formatter)
+{
+	if (formatter->widget == NULL)
+		return;
+	g_signal_handler_disconnect (formatter->widget, formatter->style_updated_id);
+	g_object_weak_unref (G_OBJECT (formatter->widget),
+			     gpk_markup_formatter_widget_destroyed_cb, formatter);
+	formatter->widget = NULL;
+	formatter->style_updated_id = 0;
+}
+
+/**
+ * gpk_markup_formatter_set_widget:
+ *
+ * The color for the second line is looked up from the style of @widget
+ * now and again only when the style changes, rather than for each row.
+ **/
+void
+gpk_markup_formatter_set_widget (GpkMarkupFormatter *formatter, GtkWidget *widget)
+{
+	g_return_if_fail (GPK_IS_MARKUP_FORMATTER (formatter));
+
+	gpk_markup_formatter_unset_widget (formatter);
+	if (widget != NULL) {
+		formatter->widget = widget;
+		g_object_weak_ref (G_OBJECT (widget),
+				   gpk_markup_formatter_widget_destroyed_cb, formatter);
+		formatter->style_updated_id =
+			g_signal_connect (widget, "style-updated",
+					  G_CALLBACK (gpk_markup_formatter_style_updated_cb),
+					  formatter);
+	}
+	gpk_markup_formatter_update_color (formatter);
+}
+
+/**
+ * gpk_markup_formatter_get_color:
+ **/
+const gchar *
+gpk_markup_formatter_get_color (GpkMarkupFormatter *formatter)
+{
+	g_return_val_if_fail (GPK_IS_MARKUP_FORMATTER (formatter), NULL);
+	return formatter->color;
+}
+
+/**
+ * gpk_markup_formatter_format:
+ *
+ * Formats a single row on the calling thread.
+ **/
+gchar *
+gpk_markup_formatter_format (GpkMarkupFormatter *formatter,
+			     const gchar *package_id,
+			     const gchar *summary)
+{
+	g_return_val_if_fail (GPK_IS_MARKUP_FORMATTER (formatter), NULL);
+	return gpk_package_id_format_twoline_color (formatter->color, package_id, summary);
+}
+
+/**
+ * gpk_markup_formatter_format_async:
+ * @packages: the #PkPackage objects, which must not be changed until done
+ *
+ * Formats the two line markup for each package on a thread pool.
+ **/
+void
+gpk_markup_formatter_format_async (GpkMarkupFormatter *formatter,
+				   GPtrArray *packages,
+				   GCancellable *cancellable,
+				   GAsyncReadyCallback callback,
+				   gpointer user_data)
+{
+	GpkMarkupFormatterBatch *batch;
+	GpkMarkupFormatterJob *job;
+	GTask *task;
+	guint i;
+
+	g_return_if_fail (GPK_IS_MARKUP_FORMATTER (formatter));
+	g_return_if_fail (packages != NULL);
+
+	task = g_task_new (formatter, cancellable, callback, user_data);
+	batch = g_new0 (GpkMarkupFormatterBatch, 1);
+	batch->packages = g_ptr_array_ref (packages);
+	batch->markup = g_ptr_array_new_with_free_func (g_free);
+	g_ptr_array_set_size (batch->markup, packages->len);
+	batch->color = g_strdup (formatter->color);
+	batch->pending = (packages->len + GPK_MARKUP_FORMATTER_CHUNK - 1) / GPK_MARKUP_FORMATTER_CHUNK;
+	g_task_set_task_data (task, batch, (GDestroyNotify) gpk_markup_formatter_batch_free);
+
+	/* nothing to do */
+	if (batch->pending == 0) {
+		g_task_return_pointer (task, g_ptr_array_ref (batch->markup),
+				       (GDestroyNotify) g_ptr_array_unref);
+		g_object_unref (task);
+		return;
+	}
+
+	/* split up so each thread gets some work */
+	for (i = 0; i < packages->len; i += GPK_MARKUP_FORMATTER_CHUNK) {
+		job = g_new0 (GpkMarkupFormatterJob, 1);
+		job->task = g_object_ref (task);
+		job->start = i;
+		job->end = MIN (i + GPK_MARKUP_FORMATTER_CHUNK, packages->len);
+		g_thread_pool_push (gpk_markup_formatter_get_pool (), job, NULL);
+	}
+	g_object_unref (task);
+}
+
+/**
+ * gpk_markup_formatter_format_finish:
+ *
+ * Return value: (transfer container): the markup, in the same order as the packages
+ **/
+GPtrArray *
+gpk_markup_formatter_format_finish (GpkMarkupFormatter *formatter,
+				    GAsyncResult *res,
+				    GError **error)
+{
+	g_return_val_if_fail (g_task_is_valid (res, formatter), NULL);
+	return g_task_propagate_pointer (G_TASK (res), error);
+}
+
+static void
+gpk_markup_formatter_finalize (GObject *object)
+{
+	GpkMarkupFormatter *formatter = GPK_MARKUP_FORMATTER (object);
+
+	gpk_markup_formatter_unset_widget (formatter);
+	g_free (formatter->color);
+
+	G_OBJECT_CLASS (gpk_markup_formatter_parent_class)->finalize (object);
+}
+
+static void
+gpk_markup_formatter_class_init (GpkMarkupFormatterClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	object_class->finalize = gpk_markup_formatter_finalize;
+}
+
+static void
+gpk_markup_formatter_init (GpkMarkupFormatter *formatter)
+{
+	gpk_markup_formatter_update_color (formatter);
+}
+
+/**
+ * gpk_markup_formatter_new:
+ **/
+GpkMarkupFormatter *
+gpk_markup_formatter_new (void)
+{
+	return g_object_new (GPK_TYPE_MARKUP_FORMATTER, NULL);
+}
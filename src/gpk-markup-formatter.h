@@ -0,0 +1,51 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef GPK_MARKUP_FORMATTER_H
+#define GPK_MARKUP_FORMATTER_H
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+#define GPK_TYPE_MARKUP_FORMATTER (gpk_markup_formatter_get_type())
+G_DECLARE_FINAL_TYPE (GpkMarkupFormatter, gpk_markup_formatter, GPK, MARKUP_FORMATTER, GObject)
+
+GType		 gpk_markup_formatter_get_type		(void);
+GpkMarkupFormatter *gpk_markup_formatter_new		(void);
+void		 gpk_markup_formatter_set_widget	(GpkMarkupFormatter *formatter,
+							 GtkWidget	*widget);
+const gchar	*gpk_markup_formatter_get_color		(GpkMarkupFormatter *formatter);
+gchar		*gpk_markup_formatter_format		(GpkMarkupFormatter *formatter,
+							 const gchar	*package_id,
+							 const gchar	*summary);
+void		 gpk_markup_formatter_format_async	(GpkMarkupFormatter *formatter,
+							 GPtrArray	*packages,
+							 GCancellable	*cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer	 user_data);
+GPtrArray	*gpk_markup_formatter_format_finish	(GpkMarkupFormatter *formatter,
+							 GAsyncResult	*res,
+							 GError		**error);
+
+G_END_DECLS
+
+#endif /* GPK_MARKUP_FORMATTER_H */
@@ -0,0 +1,850 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+#include <packagekit-glib2/packagekit.h>
+
+#include "gpk-package-cache.h"
+
+/*
+ * The file is a header, a table of fixed-size package records, a table
+ * of groups, the package indexes of each group and then a block of NUL
+ * terminated strings. Strings are stored as offsets into the block, so
+ * the file can be mapped and used without copying anything. Values are
+ * in host byte order; a file from another machine fails the version
+ * check and is rebuilt.
+ */
+#define GPK_PACKAGE_CACHE_MAGIC		"GPKCACHE"
+#define GPK_PACKAGE_CACHE_VERSION	1
+
+#define GPK_PACKAGE_CACHE_FLAG_COMPLETE	(1u << 0)
+
+typedef struct {
+	gchar			 magic[8];
+	guint32			 version;
+	guint32			 flags;
+	guint64			 filters;
+	guint32			 n_items;
+	guint32			 n_groups;
+	guint32			 n_members;
+	guint32			 strings_size;
+} GpkPackageCacheHeader;
+
+typedef struct {
+	guint32			 package_id;
+	guint32			 summary;
+	guint32			 info;
+	guint32			 reserved;
+} GpkPackageCacheRecord;
+
+typedef struct {
+	guint32			 name;
+	guint32			 first;
+	guint32			 n_members;
+	guint32			 reserved;
+} GpkPackageCacheGroup;
+
+typedef struct {
+	const gchar		*package_id;
+	const gchar		*summary;
+	PkInfoEnum		 info;
+} GpkPackageCacheItem;
+
+struct _GpkPackageCache
+{
+	GObject			 parent_instance;
+	gchar			*filename;
+	GMappedFile		*mapped;	/* strings from the last load */
+	GStringChunk		*strings;	/* strings added since */
+	GArray			*items;		/* of GpkPackageCacheItem */
+	GHashTable		*index;		/* package_id : item index + 1 */
+	GHashTable		*groups;	/* group : GArray of item index */
+	GHashTable		*names_index;	/* trigram : GArray of item index */
+	GHashTable		*details_index;	/* as above, with the summary too */
+	PkBitfield		 filters;
+	gboolean		 complete;	/* items has every package */
+	gboolean		 dirty;
+};
+
+G_DEFINE_TYPE (GpkPackageCache, gpk_package_cache, G_TYPE_OBJECT)
+
+static void
+gpk_package_cache_index_invalidate (GpkPackageCache *cache)
+{
+	g_clear_pointer (&cache->names_index, g_hash_table_unref);
+	g_clear_pointer (&cache->details_index, g_hash_table_unref);
+}
+
+static void
+gpk_package_cache_clear (GpkPackageCache *cache)
+{
+	gpk_package_cache_index_invalidate (cache);
+	g_hash_table_remove_all (cache->groups);
+	g_hash_table_remove_all (cache->index);
+	g_array_set_size (cache->items, 0);
+	g_string_chunk_clear (cache->strings);
+	if (cache->mapped != NULL) {
+		g_mapped_file_unref (cache->mapped);
+		cache->mapped = NULL;
+	}
+	cache->complete = FALSE;
+}
+
+static guint
+gpk_package_cache_add_item (GpkPackageCache *cache,
+			    const gchar *package_id,
+			    const gchar *summary,
+			    PkInfoEnum info)
+{
+	GpkPackageCacheItem item;
+
+	item.package_id = package_id;
+	item.summary = summary;
+	item.info = info;
+	g_array_append_val (cache->items, item);
+	g_hash_table_insert (cache->index, (gpointer) package_id,
+			     GUINT_TO_POINTER (cache->items->len));
+	return cache->items->len - 1;
+}
+
+static const gchar *
+gpk_package_cache_get_string (const gchar *strings, gsize strings_size, guint32 offset)
+{
+	if (offset >= strings_size)
+		return NULL;
+	return strings + offset;
+}
+
+/**
+ * gpk_package_cache_load:
+ *
+ * Maps the cache file. Any packages already in the cache are dropped,
+ * even if the file cannot be loaded.
+ **/
+gboolean
+gpk_package_cache_load (GpkPackageCache *cache, GError **error)
+{
+	const GpkPackageCacheGroup *groups;
+	const GpkPackageCacheHeader *header;
+	const GpkPackageCacheRecord *records;
+	const guint32 *members;
+	const gchar *data;
+	const gchar *strings;
+	gsize size;
+	guint64 size_expected;
+	guint i;
+	guint j;
+
+	g_return_val_if_fail (GPK_IS_PACKAGE_CACHE (cache), FALSE);
+
+	gpk_package_cache_clear (cache);
+	cache->dirty = FALSE;
+	cache->mapped = g_mapped_file_new (cache->filename, FALSE, error);
+	if (cache->mapped == NULL)
+		return FALSE;
+
+	/* check the header */
+	data = g_mapped_file_get_contents (cache->mapped);
+	size = g_mapped_file_get_length (cache->mapped);
+	header = (const GpkPackageCacheHeader *) data;
+	if (size < sizeof (GpkPackageCacheHeader) ||
+	    memcmp (header->magic, GPK_PACKAGE_CACHE_MAGIC, sizeof (header->magic)) != 0) {
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+			     "%s is not a package cache", cache->filename);
+		goto out;
+	}
+	if (header->version != GPK_PACKAGE_CACHE_VERSION) {
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+			     "%s has unsupported version %u",
+			     cache->filename, header->version);
+		goto out;
+	}
+	size_expected = sizeof (GpkPackageCacheHeader);
+	size_expected += (guint64) header->n_items * sizeof (GpkPackageCacheRecord);
+	size_expected += (guint64) header->n_groups * sizeof (GpkPackageCacheGroup);
+	size_expected += (guint64) header->n_members * sizeof (guint32);
+	size_expected += header->strings_size;
+	if (size_expected != size) {
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+			     "%s is truncated", cache->filename);
+		goto out;
+	}
+
+	/* every string has to be terminated inside the block */
+	records = (const GpkPackageCacheRecord *) (header + 1);
+	groups = (const GpkPackageCacheGroup *) (records + header->n_items);
+	members = (const guint32 *) (groups + header->n_groups);
+	strings = (const gchar *) (members + header->n_members);
+	if (header->strings_size > 0 && strings[header->strings_size - 1] != '\0') {
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+			     "%s has unterminated strings", cache->filename);
+		goto out;
+	}
+
+	/* the strings point into the mapping */
+	for (i = 0; i < header->n_items; i++) {
+		const gchar *package_id;
+		const gchar *summary;
+		package_id = gpk_package_cache_get_string (strings, header->strings_size,
+							   records[i].package_id);
+		summary = gpk_package_cache_get_string (strings, header->strings_size,
+							records[i].summary);
+		if (package_id == NULL || summary == NULL ||
+		    records[i].info >= PK_INFO_ENUM_LAST) {
+			g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+				     "%s has an invalid package", cache->filename);
+			goto out;
+		}
+		gpk_package_cache_add_item (cache, package_id, summary, records[i].info);
+	}
+	for (i = 0; i < header->n_groups; i++) {
+		GArray *indexes;
+		const gchar *name;
+		name = gpk_package_cache_get_string (strings, header->strings_size,
+						     groups[i].name);
+		if (name == NULL ||
+		    groups[i].first > header->n_members ||
+		    groups[i].n_members > header->n_members - groups[i].first) {
+			g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+				     "%s has an invalid group", cache->filename);
+			goto out;
+		}
+		indexes = g_array_sized_new (FALSE, FALSE, sizeof (guint), groups[i].n_members);
+		g_hash_table_insert (cache->groups, g_strdup (name), indexes);
+		for (j = 0; j < groups[i].n_members; j++) {
+			guint idx = members[groups[i].first + j];
+			if (idx >= header->n_items) {
+				g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+					     "%s has an invalid group member", cache->filename);
+				goto out;
+			}
+			g_array_append_val (indexes, idx);
+		}
+	}
+	cache->filters = header->filters;
+	cache->complete = (header->flags & GPK_PACKAGE_CACHE_FLAG_COMPLETE) > 0;
+	g_debug ("loaded %u packages in %u groups from %s",
+		 header->n_items, header->n_groups, cache->filename);
+	return TRUE;
+out:
+	gpk_package_cache_clear (cache);
+	return FALSE;
+}
+
+static guint32
+gpk_package_cache_append_string (GString *strings, const gchar *str)
+{
+	guint32 offset = strings->len;
+	g_string_append_len (strings, str, strlen (str) + 1);
+	return offset;
+}
+
+/**
+ * gpk_package_cache_save:
+ *
+ * Writes the cache file, replacing the old one atomically.
+ **/
+gboolean
+gpk_package_cache_save (GpkPackageCache *cache, GError **error)
+{
+	GArray *indexes;
+	GHashTableIter iter;
+	GpkPackageCacheHeader header;
+	GpkPackageCacheItem *item;
+	const gchar *name;
+	guint i;
+	g_autofree gchar *dirname = NULL;
+	g_autoptr(GArray) groups = NULL;
+	g_autoptr(GArray) members = NULL;
+	g_autoptr(GArray) records = NULL;
+	g_autoptr(GByteArray) buf = NULL;
+	g_autoptr(GString) strings = NULL;
+
+	g_return_val_if_fail (GPK_IS_PACKAGE_CACHE (cache), FALSE);
+
+	/* lay out the tables */
+	strings = g_string_sized_new (cache->items->len * 64);
+	records = g_array_sized_new (FALSE, TRUE, sizeof (GpkPackageCacheRecord),
+				     cache->items->len);
+	for (i = 0; i < cache->items->len; i++) {
+		GpkPackageCacheRecord record = { 0 };
+		item = &g_array_index (cache->items, GpkPackageCacheItem, i);
+		record.package_id = gpk_package_cache_append_string (strings, item->package_id);
+		record.summary = gpk_package_cache_append_string (strings, item->summary);
+		record.info = item->info;
+		g_array_append_val (records, record);
+	}
+	groups = g_array_new (FALSE, TRUE, sizeof (GpkPackageCacheGroup));
+	members = g_array_new (FALSE, FALSE, sizeof (guint32));
+	g_hash_table_iter_init (&iter, cache->groups);
+	while (g_hash_table_iter_next (&iter, (gpointer *) &name, (gpointer *) &indexes)) {
+		GpkPackageCacheGroup group = { 0 };
+		group.name = gpk_package_cache_append_string (strings, name);
+		group.first = members->len;
+		group.n_members = indexes->len;
+		for (i = 0; i < indexes->len; i++) {
+			guint32 idx = g_array_index (indexes, guint, i);
+			g_array_append_val (members, idx);
+		}
+		g_array_append_val (groups, group);
+	}
+
+	/* write it all in one go */
+	memset (&header, 0, sizeof (header));
+	memcpy (header.magic, GPK_PACKAGE_CACHE_MAGIC, sizeof (header.magic));
+	header.version = GPK_PACKAGE_CACHE_VERSION;
+	header.flags = cache->complete ? GPK_PACKAGE_CACHE_FLAG_COMPLETE : 0;
+	header.filters = cache->filters;
+	header.n_items = records->len;
+	header.n_groups = groups->len;
+	header.n_members = members->len;
+	header.strings_size = strings->len;
+	buf = g_byte_array_sized_new (sizeof (header) +
+				      records->len * sizeof (GpkPackageCacheRecord) +
+				      groups->len * sizeof (GpkPackageCacheGroup) +
+				      members->len * sizeof (guint32) +
+				      strings->len);
+	g_byte_array_append (buf, (const guint8 *) &header, sizeof (header));
+	g_byte_array_append (buf, (const guint8 *) records->data,
+			     records->len * sizeof (GpkPackageCacheRecord));
+	g_byte_array_append (buf, (const guint8 *) groups->data,
+			     groups->len * sizeof (GpkPackageCacheGroup));
+	g_byte_array_append (buf, (const guint8 *) members->data,
+			     members->len * sizeof (guint32));
+	g_byte_array_append (buf, (const guint8 *) strings->str, strings->len);
+
+	dirname = g_path_get_dirname (cache->filename);
+	if (g_mkdir_with_parents (dirname, 0755) < 0) {
+		g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+			     "failed to create %s: %s", dirname, g_strerror (errno));
+		return FALSE;
+	}
+	if (!g_file_set_contents (cache->filename, (const gchar *) buf->data, buf->len, error))
+		return FALSE;
+	g_debug ("saved %u packages in %u groups to %s",
+		 header.n_items, header.n_groups, cache->filename);
+	cache->dirty = FALSE;
+	return TRUE;
+}
+
+/**
+ * gpk_package_cache_invalidate:
+ *
+ * Forgets everything and deletes the cache file, for instance when the
+ * repositories or the installed packages have changed.
+ **/
+void
+gpk_package_cache_invalidate (GpkPackageCache *cache)
+{
+	g_return_if_fail (GPK_IS_PACKAGE_CACHE (cache));
+
+	gpk_package_cache_clear (cache);
+	cache->dirty = FALSE;
+	if (g_unlink (cache->filename) < 0 && errno != ENOENT)
+		g_warning ("failed to delete %s: %s", cache->filename, g_strerror (errno));
+}
+
+/**
+ * gpk_package_cache_get_dirty:
+ *
+ * Return value: %TRUE if there are changes that have not been saved
+ **/
+gboolean
+gpk_package_cache_get_dirty (GpkPackageCache *cache)
+{
+	g_return_val_if_fail (GPK_IS_PACKAGE_CACHE (cache), FALSE);
+	return cache->dirty;
+}
+
+static gboolean
+gpk_package_cache_array_equal (GArray *a, GArray *b)
+{
+	if (a->len != b->len)
+		return FALSE;
+	return memcmp (a->data, b->data, a->len * sizeof (guint)) == 0;
+}
+
+static gboolean
+gpk_package_cache_is_current (GpkPackageCache *cache, GPtrArray *packages)
+{
+	GpkPackageCacheItem *item;
+	PkPackage *package;
+	guint i;
+	guint idx;
+
+	if (!cache->complete || packages->len != cache->items->len)
+		return FALSE;
+	for (i = 0; i < packages->len; i++) {
+		package = g_ptr_array_index (packages, i);
+		idx = GPOINTER_TO_UINT (g_hash_table_lookup (cache->index,
+							     pk_package_get_id (package)));
+		if (idx == 0)
+			return FALSE;
+		item = &g_array_index (cache->items, GpkPackageCacheItem, idx - 1);
+		if (item->info != pk_package_get_info (package) ||
+		    g_strcmp0 (item->summary, pk_package_get_summary (package)) != 0)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * gpk_package_cache_add_packages:
+ * @filters: the filters used to get @packages
+ * @group: the group that was searched, or %NULL for every package
+ * @packages: the #PkPackage results
+ *
+ * Adds the results of a transaction to the cache. The cache only holds
+ * results for one set of filters, so anything cached with different
+ * filters is dropped.
+ *
+ * Return value: %TRUE if the results differ from what was cached
+ **/
+gboolean
+gpk_package_cache_add_packages (GpkPackageCache *cache,
+				PkBitfield filters,
+				const gchar *group,
+				GPtrArray *packages)
+{
+	GArray *indexes_old = NULL;
+	PkPackage *package;
+	gboolean changed = FALSE;
+	const gchar *package_id;
+	const gchar *summary;
+	guint i;
+	guint idx;
+	g_autoptr(GArray) indexes = NULL;
+
+	g_return_val_if_fail (GPK_IS_PACKAGE_CACHE (cache), FALSE);
+
+	/* start again */
+	if (cache->filters != filters) {
+		gpk_package_cache_clear (cache);
+		cache->filters = filters;
+		changed = TRUE;
+	}
+
+	/* a new list of everything replaces all we know */
+	if (group == NULL) {
+		if (gpk_package_cache_is_current (cache, packages))
+			return FALSE;
+		gpk_package_cache_clear (cache);
+	}
+
+	indexes = g_array_sized_new (FALSE, FALSE, sizeof (guint), packages->len);
+	for (i = 0; i < packages->len; i++) {
+		GpkPackageCacheItem *item;
+		PkInfoEnum info;
+
+		package = g_ptr_array_index (packages, i);
+		package_id = pk_package_get_id (package);
+		summary = pk_package_get_summary (package);
+		info = pk_package_get_info (package);
+		if (package_id == NULL)
+			continue;
+		if (summary == NULL)
+			summary = "";
+
+		idx = GPOINTER_TO_UINT (g_hash_table_lookup (cache->index, package_id));
+		if (idx == 0) {
+			idx = gpk_package_cache_add_item (cache,
+							  g_string_chunk_insert (cache->strings, package_id),
+							  g_string_chunk_insert (cache->strings, summary),
+							  info);
+			changed = TRUE;
+		} else {
+			idx--;
+			item = &g_array_index (cache->items, GpkPackageCacheItem, idx);
+			if (item->info != info) {
+				item->info = info;
+				changed = TRUE;
+			}
+			if (g_strcmp0 (item->summary, summary) != 0) {
+				item->summary = g_string_chunk_insert (cache->strings, summary);
+				changed = TRUE;
+			}
+		}
+		g_array_append_val (indexes, idx);
+	}
+
+	/* every package has been added */
+	if (group == NULL) {
+		gpk_package_cache_index_invalidate (cache);
+		cache->complete = TRUE;
+		cache->dirty = TRUE;
+		return TRUE;
+	}
+
+	/* the group membership may have changed */
+	indexes_old = g_hash_table_lookup (cache->groups, group);
+	if (indexes_old == NULL || !gpk_package_cache_array_equal (indexes_old, indexes)) {
+		g_hash_table_insert (cache->groups, g_strdup (group), g_steal_pointer (&indexes));
+		changed = TRUE;
+	}
+	if (changed) {
+		gpk_package_cache_index_invalidate (cache);
+		cache->dirty = TRUE;
+	}
+	return changed;
+}
+
+static PkPackage *
+gpk_package_cache_item_to_package (GpkPackageCacheItem *item)
+{
+	PkPackage *package;
+
+	package = pk_package_new ();
+	if (!pk_package_set_id (package, item->package_id, NULL)) {
+		g_object_unref (package);
+		return NULL;
+	}
+	g_object_set (package,
+		      "info", item->info,
+		      "summary", item->summary,
+		      NULL);
+	return package;
+}
+
+static void
+gpk_package_cache_add_to_array (GPtrArray *array, GpkPackageCacheItem *item)
+{
+	PkPackage *package;
+
+	package = gpk_package_cache_item_to_package (item);
+	if (package != NULL)
+		g_ptr_array_add (array, package);
+}
+
+/**
+ * gpk_package_cache_has_packages:
+ * @filters: the filters the caller would have used
+ * @group: the group to check, or %NULL for every package
+ *
+ * Return value: %TRUE if gpk_package_cache_get_packages() would succeed
+ **/
+gboolean
+gpk_package_cache_has_packages (GpkPackageCache *cache,
+				PkBitfield filters,
+				const gchar *group)
+{
+	g_return_val_if_fail (GPK_IS_PACKAGE_CACHE (cache), FALSE);
+
+	if (cache->filters != filters)
+		return FALSE;
+	if (group == NULL)
+		return cache->complete;
+	return g_hash_table_contains (cache->groups, group);
+}
+
+/**
+ * gpk_package_cache_get_packages:
+ * @filters: the filters the caller would have used
+ * @group: the group to get, or %NULL for every package
+ *
+ * Return value: (transfer container): an array of #PkPackage, or %NULL
+ * if the cache does not know the answer
+ **/
+GPtrArray *
+gpk_package_cache_get_packages (GpkPackageCache *cache,
+				PkBitfield filters,
+				const gchar *group)
+{
+	GArray *indexes;
+	GPtrArray *array;
+	guint i;
+
+	g_return_val_if_fail (GPK_IS_PACKAGE_CACHE (cache), NULL);
+
+	if (!gpk_package_cache_has_packages (cache, filters, group))
+		return NULL;
+
+	/* all packages */
+	if (group == NULL) {
+		array = g_ptr_array_new_full (cache->items->len, g_object_unref);
+		for (i = 0; i < cache->items->len; i++) {
+			gpk_package_cache_add_to_array (array,
+							&g_array_index (cache->items,
+									GpkPackageCacheItem, i));
+		}
+		return array;
+	}
+
+	/* one group */
+	indexes = g_hash_table_lookup (cache->groups, group);
+	array = g_ptr_array_new_full (indexes->len, g_object_unref);
+	for (i = 0; i < indexes->len; i++) {
+		gpk_package_cache_add_to_array (array,
+						&g_array_index (cache->items, GpkPackageCacheItem,
+								g_array_index (indexes, guint, i)));
+	}
+	return array;
+}
+
+static gboolean
+gpk_package_cache_strncasestr (const gchar *haystack, gsize haystack_len, const gchar *needle)
+{
+	gsize needle_len = strlen (needle);
+	gsize i;
+
+	if (needle_len > haystack_len)
+		return FALSE;
+	for (i = 0; i + needle_len <= haystack_len; i++) {
+		if (g_ascii_strncasecmp (haystack + i, needle, needle_len) == 0)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+/*
+ * Searches use an index of every three byte sequence, folded to lower
+ * case, to find the packages that could match. The rarest trigram in
+ * the query gives the smallest set of candidates, which are then checked
+ * properly. Terms shorter than three bytes cannot use the index.
+ */
+static guint32
+gpk_package_cache_trigram (const gchar *str)
+{
+	return ((guint32) (guchar) g_ascii_tolower (str[0]) << 16) |
+	       ((guint32) (guchar) g_ascii_tolower (str[1]) << 8) |
+	       (guint32) (guchar) g_ascii_tolower (str[2]);
+}
+
+static void
+gpk_package_cache_index_text (GHashTable *index, const gchar *text, gsize len, guint idx)
+{
+	GArray *postings;
+	gpointer key;
+	gsize i;
+
+	for (i = 0; i + 3 <= len; i++) {
+		key = GUINT_TO_POINTER (gpk_package_cache_trigram (text + i));
+		postings = g_hash_table_lookup (index, key);
+		if (postings == NULL) {
+			postings = g_array_new (FALSE, FALSE, sizeof (guint));
+			g_hash_table_insert (index, key, postings);
+		}
+
+		/* items are added in order, so a repeat is always the last */
+		if (postings->len > 0 &&
+		    g_array_index (postings, guint, postings->len - 1) == idx)
+			continue;
+		g_array_append_val (postings, idx);
+	}
+}
+
+static void
+gpk_package_cache_ensure_index (GpkPackageCache *cache)
+{
+	GpkPackageCacheItem *item;
+	gsize name_len;
+	guint i;
+	g_autoptr(GTimer) timer = NULL;
+
+	if (cache->names_index != NULL)
+		return;
+
+	timer = g_timer_new ();
+	cache->names_index = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+						    NULL, (GDestroyNotify) g_array_unref);
+	cache->details_index = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+						      NULL, (GDestroyNotify) g_array_unref);
+	for (i = 0; i < cache->items->len; i++) {
+		item = &g_array_index (cache->items, GpkPackageCacheItem, i);
+		name_len = strcspn (item->package_id, ";");
+		gpk_package_cache_index_text (cache->names_index,
+					      item->package_id, name_len, i);
+		gpk_package_cache_index_text (cache->details_index,
+					      item->package_id, name_len, i);
+		gpk_package_cache_index_text (cache->details_index,
+					      item->summary, strlen (item->summary), i);
+	}
+	g_debug ("indexed %u packages into %u trigrams in %.1fms",
+		 cache->items->len, g_hash_table_size (cache->details_index),
+		 g_timer_elapsed (timer, NULL) * 1000);
+}
+
+static gboolean
+gpk_package_cache_item_matches (GpkPackageCacheItem *item, gchar **values, gboolean details)
+{
+	gsize name_len;
+	guint i;
+
+	name_len = strcspn (item->package_id, ";");
+	for (i = 0; values[i] != NULL; i++) {
+		if (gpk_package_cache_strncasestr (item->package_id, name_len, values[i]))
+			continue;
+		if (details &&
+		    gpk_package_cache_strncasestr (item->summary, strlen (item->summary), values[i]))
+			continue;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static GPtrArray *
+gpk_package_cache_search (GpkPackageCache *cache,
+			  PkBitfield filters,
+			  gchar **values,
+			  gboolean details)
+{
+	GArray *best = NULL;
+	GArray *postings;
+	GHashTable *index;
+	GPtrArray *array;
+	GpkPackageCacheItem *item;
+	gsize len;
+	guint i;
+	guint j;
+
+	if (!gpk_package_cache_has_packages (cache, filters, NULL))
+		return NULL;
+
+	/* find the rarest trigram in any of the terms */
+	gpk_package_cache_ensure_index (cache);
+	index = details ? cache->details_index : cache->names_index;
+	array = g_ptr_array_new_with_free_func (g_object_unref);
+	for (i = 0; values[i] != NULL; i++) {
+		len = strlen (values[i]);
+		for (j = 0; j + 3 <= len; j++) {
+			postings = g_hash_table_lookup (index,
+							GUINT_TO_POINTER (gpk_package_cache_trigram (values[i] + j)));
+			if (postings == NULL)
+				return array;
+			if (best == NULL || postings->len < best->len)
+				best = postings;
+		}
+	}
+
+	/* every term is too short, so check everything */
+	if (best == NULL) {
+		for (i = 0; i < cache->items->len; i++) {
+			item = &g_array_index (cache->items, GpkPackageCacheItem, i);
+			if (gpk_package_cache_item_matches (item, values, details))
+				gpk_package_cache_add_to_array (array, item);
+		}
+		return array;
+	}
+
+	/* only check the candidates */
+	for (i = 0; i < best->len; i++) {
+		item = &g_array_index (cache->items, GpkPackageCacheItem,
+				       g_array_index (best, guint, i));
+		if (gpk_package_cache_item_matches (item, values, details))
+			gpk_package_cache_add_to_array (array, item);
+	}
+	return array;
+}
+
+/**
+ * gpk_package_cache_search_names:
+ * @filters: the filters the caller would have used
+ * @values: the search terms, which all have to match the package name
+ *
+ * This is only an approximation of what the backend would do, so the
+ * real search should still be run afterwards.
+ *
+ * Return value: (transfer container): an array of #PkPackage, or %NULL
+ * if the cache does not have every package
+ **/
+GPtrArray *
+gpk_package_cache_search_names (GpkPackageCache *cache,
+				PkBitfield filters,
+				gchar **values)
+{
+	g_return_val_if_fail (GPK_IS_PACKAGE_CACHE (cache), NULL);
+	g_return_val_if_fail (values != NULL, NULL);
+	return gpk_package_cache_search (cache, filters, values, FALSE);
+}
+
+/**
+ * gpk_package_cache_search_details:
+ * @filters: the filters the caller would have used
+ * @values: the search terms, which all have to match the package name
+ * or summary
+ *
+ * The backend also searches the description and other fields that are
+ * not cached, so the real search should still be run afterwards.
+ *
+ * Return value: (transfer container): an array of #PkPackage, or %NULL
+ * if the cache does not have every package
+ **/
+GPtrArray *
+gpk_package_cache_search_details (GpkPackageCache *cache,
+				  PkBitfield filters,
+				  gchar **values)
+{
+	g_return_val_if_fail (GPK_IS_PACKAGE_CACHE (cache), NULL);
+	g_return_val_if_fail (values != NULL, NULL);
+	return gpk_package_cache_search (cache, filters, values, TRUE);
+}
+
+static void
+gpk_package_cache_finalize (GObject *object)
+{
+	GpkPackageCache *cache = GPK_PACKAGE_CACHE (object);
+
+	gpk_package_cache_index_invalidate (cache);
+	g_hash_table_unref (cache->groups);
+	g_hash_table_unref (cache->index);
+	g_array_unref (cache->items);
+	g_string_chunk_free (cache->strings);
+	if (cache->mapped != NULL)
+		g_mapped_file_unref (cache->mapped);
+	g_free (cache->filename);
+
+	G_OBJECT_CLASS (gpk_package_cache_parent_class)->finalize (object);
+}
+
+static void
+gpk_package_cache_class_init (GpkPackageCacheClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	object_class->finalize = gpk_package_cache_finalize;
+}
+
+static void
+gpk_package_cache_init (GpkPackageCache *cache)
+{
+	cache->items = g_array_new (FALSE, FALSE, sizeof (GpkPackageCacheItem));
+	cache->index = g_hash_table_new (g_str_hash, g_str_equal);
+	cache->groups = g_hash_table_new_full (g_str_hash, g_str_equal,
+					       g_free, (GDestroyNotify) g_array_unref);
+	cache->strings = g_string_chunk_new (64 * 1024);
+}
+
+/**
+ * gpk_package_cache_new:
+ * @filename: the cache file, which does not have to exist yet
+ **/
+GpkPackageCache *
+gpk_package_cache_new (const gchar *filename)
+{
+	GpkPackageCache *cache;
+	cache = g_object_new (GPK_TYPE_PACKAGE_CACHE, NULL);
+	cache->filename = g_strdup (filename);
+	return cache;
+}
@@ -0,0 +1,60 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef GPK_PACKAGE_CACHE_H
+#define GPK_PACKAGE_CACHE_H
+
+#include <glib-object.h>
+#include <packagekit-glib2/packagekit.h>
+
+G_BEGIN_DECLS
+
+#define GPK_TYPE_PACKAGE_CACHE (gpk_package_cache_get_type())
+G_DECLARE_FINAL_TYPE (GpkPackageCache, gpk_package_cache, GPK, PACKAGE_CACHE, GObject)
+
+GType		 gpk_package_cache_get_type		(void);
+GpkPackageCache	*gpk_package_cache_new			(const gchar	*filename);
+gboolean	 gpk_package_cache_load			(GpkPackageCache *cache,
+							 GError		**error);
+gboolean	 gpk_package_cache_save			(GpkPackageCache *cache,
+							 GError		**error);
+void		 gpk_package_cache_invalidate		(GpkPackageCache *cache);
+gboolean	 gpk_package_cache_get_dirty		(GpkPackageCache *cache);
+gboolean	 gpk_package_cache_add_packages		(GpkPackageCache *cache,
+							 PkBitfield	 filters,
+							 const gchar	*group,
+							 GPtrArray	*packages);
+gboolean	 gpk_package_cache_has_packages		(GpkPackageCache *cache,
+							 PkBitfield	 filters,
+							 const gchar	*group);
+GPtrArray	*gpk_package_cache_get_packages		(GpkPackageCache *cache,
+							 PkBitfield	 filters,
+							 const gchar	*group);
+GPtrArray	*gpk_package_cache_search_names		(GpkPackageCache *cache,
+							 PkBitfield	 filters,
+							 gchar		**values);
+GPtrArray	*gpk_package_cache_search_details	(GpkPackageCache *cache,
+							 PkBitfield	 filters,
+							 gchar		**values);
+
+G_END_DECLS
+
+#endif /* GPK_PACKAGE_CACHE_H */
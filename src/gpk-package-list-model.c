@@ -0,0 +1,732 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+#include <packagekit-glib2/packagekit.h>
+
+#include "gpk-common.h"
+#include "gpk-package-list-model.h"
+#include "gpk-string-pool.h"
+
+/*
+ * Each row is a small fixed-size record. The arch and data fields are
+ * interned in the shared string pool as they only have a few distinct
+ * values, and the name, version and summary are copied into an arena
+ * that is freed in one go.
+ * The package ID and the markup are only built when a column is read.
+ */
+typedef struct {
+	const gchar		*name;		/* NULL for a message row */
+	const gchar		*version;
+	const gchar		*arch;
+	const gchar		*data;
+	const gchar		*summary;	/* or the text of a message row */
+	const gchar		*icon;		/* static string */
+	PkBitfield		 state;
+	guint			 checkbox:1;
+	guint			 checkbox_visible:1;
+} GpkPackageListItem;
+
+struct _GpkPackageListModel
+{
+	GObject			 parent_instance;
+	GArray			*items;		/* of GpkPackageListItem */
+	GArray			*order;		/* of guint, row to item index */
+	GStringChunk		*arena;
+	GtkStyleContext		*style;
+	gchar			*color;		/* from the style */
+	gint			 stamp;
+	gint			 sort_column_id;
+	GtkSortType		 sort_order;
+};
+
+static void gpk_package_list_model_tree_model_init (GtkTreeModelIface *iface);
+static void gpk_package_list_model_sortable_init (GtkTreeSortableIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (GpkPackageListModel, gpk_package_list_model, G_TYPE_OBJECT,
+			 G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+						gpk_package_list_model_tree_model_init)
+			 G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_SORTABLE,
+						gpk_package_list_model_sortable_init))
+
+static GpkPackageListItem *
+gpk_package_list_model_get_item (GpkPackageListModel *model, guint row)
+{
+	guint idx = g_array_index (model->order, guint, row);
+	return &g_array_index (model->items, GpkPackageListItem, idx);
+}
+
+static GpkPackageListItem *
+gpk_package_list_model_get_item_for_iter (GpkPackageListModel *model, GtkTreeIter *iter)
+{
+	g_return_val_if_fail (iter->stamp == model->stamp, NULL);
+	return gpk_package_list_model_get_item (model, GPOINTER_TO_UINT (iter->user_data));
+}
+
+static void
+gpk_package_list_model_set_iter (GpkPackageListModel *model, GtkTreeIter *iter, guint row)
+{
+	iter->stamp = model->stamp;
+	iter->user_data = GUINT_TO_POINTER (row);
+}
+
+static GtkTreeModelFlags
+gpk_package_list_model_get_flags (GtkTreeModel *tree_model)
+{
+	return GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint
+gpk_package_list_model_get_n_columns (GtkTreeModel *tree_model)
+{
+	return GPK_PACKAGE_LIST_COLUMN_LAST;
+}
+
+static GType
+gpk_package_list_model_get_column_type (GtkTreeModel *tree_model, gint column)
+{
+	switch (column) {
+	case GPK_PACKAGE_LIST_COLUMN_STATE:
+		return G_TYPE_UINT64;
+	case GPK_PACKAGE_LIST_COLUMN_CHECKBOX:
+	case GPK_PACKAGE_LIST_COLUMN_CHECKBOX_VISIBLE:
+		return G_TYPE_BOOLEAN;
+	case GPK_PACKAGE_LIST_COLUMN_IMAGE:
+	case GPK_PACKAGE_LIST_COLUMN_TEXT:
+	case GPK_PACKAGE_LIST_COLUMN_ID:
+	case GPK_PACKAGE_LIST_COLUMN_SUMMARY:
+		return G_TYPE_STRING;
+	default:
+		break;
+	}
+	return G_TYPE_INVALID;
+}
+
+static gboolean
+gpk_package_list_model_get_iter (GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreePath *path)
+{
+	GpkPackageListModel *model = GPK_PACKAGE_LIST_MODEL (tree_model);
+	gint row;
+
+	if (gtk_tree_path_get_depth (path) != 1)
+		return FALSE;
+	row = gtk_tree_path_get_indices (path)[0];
+	if (row < 0 || (guint) row >= model->order->len)
+		return FALSE;
+	gpk_package_list_model_set_iter (model, iter, row);
+	return TRUE;
+}
+
+static GtkTreePath *
+gpk_package_list_model_get_path (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	GpkPackageListModel *model = GPK_PACKAGE_LIST_MODEL (tree_model);
+	g_return_val_if_fail (iter->stamp == model->stamp, NULL);
+	return gtk_tree_path_new_from_indices (GPOINTER_TO_UINT (iter->user_data), -1);
+}
+
+static gchar *
+gpk_package_list_model_item_get_id (GpkPackageListItem *item)
+{
+	if (item->name == NULL)
+		return NULL;
+	return pk_package_id_build (item->name, item->version, item->arch, item->data);
+}
+
+static void
+gpk_package_list_model_get_value (GtkTreeModel *tree_model, GtkTreeIter *iter,
+				  gint column, GValue *value)
+{
+	GpkPackageListModel *model = GPK_PACKAGE_LIST_MODEL (tree_model);
+	GpkPackageListItem *item;
+	g_autofree gchar *package_id = NULL;
+
+	g_value_init (value, gpk_package_list_model_get_column_type (tree_model, column));
+	item = gpk_package_list_model_get_item_for_iter (model, iter);
+	if (item == NULL)
+		return;
+
+	switch (column) {
+	case GPK_PACKAGE_LIST_COLUMN_IMAGE:
+		g_value_set_static_string (value, item->icon);
+		break;
+	case GPK_PACKAGE_LIST_COLUMN_STATE:
+		g_value_set_uint64 (value, item->state);
+		break;
+	case GPK_PACKAGE_LIST_COLUMN_CHECKBOX:
+		g_value_set_boolean (value, item->checkbox);
+		break;
+	case GPK_PACKAGE_LIST_COLUMN_CHECKBOX_VISIBLE:
+		g_value_set_boolean (value, item->checkbox_visible);
+		break;
+	case GPK_PACKAGE_LIST_COLUMN_TEXT:
+		/* only format the rows that are actually drawn */
+		if (item->name == NULL) {
+			g_value_set_string (value, item->summary);
+			break;
+		}
+		package_id = gpk_package_list_model_item_get_id (item);
+		g_value_take_string (value, gpk_package_id_format_twoline_color (model->color,
+										 package_id,
+										 item->summary));
+		break;
+	case GPK_PACKAGE_LIST_COLUMN_ID:
+		g_value_take_string (value, gpk_package_list_model_item_get_id (item));
+		break;
+	case GPK_PACKAGE_LIST_COLUMN_SUMMARY:
+		if (item->name != NULL)
+			g_value_set_string (value, item->summary);
+		break;
+	default:
+		g_warning ("invalid column %i", column);
+		break;
+	}
+}
+
+static gboolean
+gpk_package_list_model_iter_next (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	GpkPackageListModel *model = GPK_PACKAGE_LIST_MODEL (tree_model);
+	guint row = GPOINTER_TO_UINT (iter->user_data) + 1;
+
+	if (iter->stamp != model->stamp || row >= model->order->len) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	iter->user_data = GUINT_TO_POINTER (row);
+	return TRUE;
+}
+
+static gboolean
+gpk_package_list_model_iter_previous (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	GpkPackageListModel *model = GPK_PACKAGE_LIST_MODEL (tree_model);
+	guint row = GPOINTER_TO_UINT (iter->user_data);
+
+	if (iter->stamp != model->stamp || row == 0) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	iter->user_data = GUINT_TO_POINTER (row - 1);
+	return TRUE;
+}
+
+static gboolean
+gpk_package_list_model_iter_nth_child (GtkTreeModel *tree_model, GtkTreeIter *iter,
+				       GtkTreeIter *parent, gint n)
+{
+	GpkPackageListModel *model = GPK_PACKAGE_LIST_MODEL (tree_model);
+
+	/* this is a flat list */
+	if (parent != NULL || n < 0 || (guint) n >= model->order->len)
+		return FALSE;
+	gpk_package_list_model_set_iter (model, iter, n);
+	return TRUE;
+}
+
+static gboolean
+gpk_package_list_model_iter_children (GtkTreeModel *tree_model, GtkTreeIter *iter,
+				      GtkTreeIter *parent)
+{
+	return gpk_package_list_model_iter_nth_child (tree_model, iter, parent, 0);
+}
+
+static gboolean
+gpk_package_list_model_iter_has_child (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	return FALSE;
+}
+
+static gint
+gpk_package_list_model_iter_n_children (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	GpkPackageListModel *model = GPK_PACKAGE_LIST_MODEL (tree_model);
+	if (iter != NULL)
+		return 0;
+	return model->order->len;
+}
+
+static gboolean
+gpk_package_list_model_iter_parent (GtkTreeModel *tree_model, GtkTreeIter *iter,
+				    GtkTreeIter *child)
+{
+	return FALSE;
+}
+
+static void
+gpk_package_list_model_tree_model_init (GtkTreeModelIface *iface)
+{
+	iface->get_flags = gpk_package_list_model_get_flags;
+	iface->get_n_columns = gpk_package_list_model_get_n_columns;
+	iface->get_column_type = gpk_package_list_model_get_column_type;
+	iface->get_iter = gpk_package_list_model_get_iter;
+	iface->get_path = gpk_package_list_model_get_path;
+	iface->get_value = gpk_package_list_model_get_value;
+	iface->iter_next = gpk_package_list_model_iter_next;
+	iface->iter_previous = gpk_package_list_model_iter_previous;
+	iface->iter_children = gpk_package_list_model_iter_children;
+	iface->iter_has_child = gpk_package_list_model_iter_has_child;
+	iface->iter_n_children = gpk_package_list_model_iter_n_children;
+	iface->iter_nth_child = gpk_package_list_model_iter_nth_child;
+	iface->iter_parent = gpk_package_list_model_iter_parent;
+}
+
+static gint
+gpk_package_list_model_compare_interned (const gchar *str1, const gchar *str2)
+{
+	/* the same string is always the same pointer */
+	if (str1 == str2)
+		return 0;
+	return g_strcmp0 (str1, str2);
+}
+
+static gint
+gpk_package_list_model_compare_items (GpkPackageListModel *model,
+				      const GpkPackageListItem *item1,
+				      const GpkPackageListItem *item2)
+{
+	gint rc;
+
+	/* messages have no ID and sort first, like a NULL string does */
+	if (item1->name == NULL || item2->name == NULL) {
+		if (item1->name == item2->name)
+			return 0;
+		return item1->name == NULL ? -1 : 1;
+	}
+
+	/* the text column starts with the summary */
+	if (model->sort_column_id == GPK_PACKAGE_LIST_COLUMN_TEXT) {
+		rc = g_ascii_strcasecmp (item1->summary != NULL ? item1->summary : "",
+					 item2->summary != NULL ? item2->summary : "");
+		if (rc != 0)
+			return rc;
+	}
+
+	/* the package ID, one field at a time */
+	rc = g_ascii_strcasecmp (item1->name, item2->name);
+	if (rc != 0)
+		return rc;
+	rc = g_strcmp0 (item1->version, item2->version);
+	if (rc != 0)
+		return rc;
+	rc = gpk_package_list_model_compare_interned (item1->arch, item2->arch);
+	if (rc != 0)
+		return rc;
+	return gpk_package_list_model_compare_interned (item1->data, item2->data);
+}
+
+static gint
+gpk_package_list_model_compare_rows (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	GpkPackageListModel *model = GPK_PACKAGE_LIST_MODEL (user_data);
+	gint rc;
+
+	rc = gpk_package_list_model_compare_items (model,
+						   gpk_package_list_model_get_item (model, *((const gint *) a)),
+						   gpk_package_list_model_get_item (model, *((const gint *) b)));
+	if (model->sort_order == GTK_SORT_DESCENDING)
+		return -rc;
+	return rc;
+}
+
+static gboolean
+gpk_package_list_model_is_sorted (GpkPackageListModel *model)
+{
+	return model->sort_column_id != GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID &&
+	       model->sort_column_id != GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID;
+}
+
+static void
+gpk_package_list_model_sort (GpkPackageListModel *model)
+{
+	GtkTreePath *path;
+	guint i;
+	guint len = model->order->len;
+	g_autofree gint *new_order = NULL;
+	g_autofree guint *old_order = NULL;
+
+	if (!gpk_package_list_model_is_sorted (model) || len < 2)
+		return;
+
+	/* sort the rows rather than the items so the view can be told
+	 * where each row moved from */
+	new_order = g_new (gint, len);
+	for (i = 0; i < len; i++)
+		new_order[i] = i;
+	g_qsort_with_data (new_order, len, sizeof (gint),
+			   gpk_package_list_model_compare_rows, model);
+
+	old_order = g_new (guint, len);
+	memcpy (old_order, model->order->data, len * sizeof (guint));
+	for (i = 0; i < len; i++)
+		g_array_index (model->order, guint, i) = old_order[new_order[i]];
+
+	/* any existing iters now point at the wrong row */
+	model->stamp++;
+	path = gtk_tree_path_new ();
+	gtk_tree_model_rows_reordered (GTK_TREE_MODEL (model), path, NULL, new_order);
+	gtk_tree_path_free (path);
+}
+
+static guint
+gpk_package_list_model_get_insert_row (GpkPackageListModel *model, const GpkPackageListItem *item)
+{
+	guint low = 0;
+	guint high = model->order->len;
+	guint mid;
+	gint rc;
+
+	/* just add to the end */
+	if (!gpk_package_list_model_is_sorted (model))
+		return high;
+
+	/* insert after any equal rows */
+	while (low < high) {
+		mid = low + (high - low) / 2;
+		rc = gpk_package_list_model_compare_items (model, item,
+							   gpk_package_list_model_get_item (model, mid));
+		if (model->sort_order == GTK_SORT_DESCENDING)
+			rc = -rc;
+		if (rc < 0)
+			high = mid;
+		else
+			low = mid + 1;
+	}
+	return low;
+}
+
+static void
+gpk_package_list_model_insert_item (GpkPackageListModel *model, GpkPackageListItem *item,
+				    GtkTreeIter *iter)
+{
+	GtkTreeIter iter_tmp;
+	GtkTreePath *path;
+	guint idx = model->items->len;
+	guint row;
+
+	row = gpk_package_list_model_get_insert_row (model, item);
+	g_array_append_vals (model->items, item, 1);
+	g_array_insert_val (model->order, row, idx);
+
+	/* rows after this one have moved */
+	if (row + 1 < model->order->len)
+		model->stamp++;
+
+	if (iter == NULL)
+		iter = &iter_tmp;
+	gpk_package_list_model_set_iter (model, iter, row);
+	path = gtk_tree_path_new_from_indices (row, -1);
+	gtk_tree_model_row_inserted (GTK_TREE_MODEL (model), path, iter);
+	gtk_tree_path_free (path);
+}
+
+static void
+gpk_package_list_model_row_changed (GpkPackageListModel *model, GtkTreeIter *iter)
+{
+	GtkTreePath *path;
+	path = gpk_package_list_model_get_path (GTK_TREE_MODEL (model), iter);
+	gtk_tree_model_row_changed (GTK_TREE_MODEL (model), path, iter);
+	gtk_tree_path_free (path);
+}
+
+static gboolean
+gpk_package_list_model_get_sort_column_id (GtkTreeSortable *sortable,
+					   gint *sort_column_id,
+					   GtkSortType *order)
+{
+	GpkPackageListModel *model = GPK_PACKAGE_LIST_MODEL (sortable);
+
+	if (sort_column_id != NULL)
+		*sort_column_id = model->sort_column_id;
+	if (order != NULL)
+		*order = model->sort_order;
+	return gpk_package_list_model_is_sorted (model);
+}
+
+static void
+gpk_package_list_model_set_sort_column_id (GtkTreeSortable *sortable,
+					   gint sort_column_id,
+					   GtkSortType order)
+{
+	GpkPackageListModel *model = GPK_PACKAGE_LIST_MODEL (sortable);
+
+	if (model->sort_column_id == sort_column_id && model->sort_order == order)
+		return;
+	model->sort_column_id = sort_column_id;
+	model->sort_order = order;
+	gtk_tree_sortable_sort_column_changed (sortable);
+	gpk_package_list_model_sort (model);
+}
+
+static void
+gpk_package_list_model_set_sort_func (GtkTreeSortable *sortable,
+				      gint sort_column_id,
+				      GtkTreeIterCompareFunc func,
+				      gpointer data,
+				      GDestroyNotify destroy)
+{
+	g_warning ("custom sort functions are not supported");
+}
+
+static void
+gpk_package_list_model_set_default_sort_func (GtkTreeSortable *sortable,
+					      GtkTreeIterCompareFunc func,
+					      gpointer data,
+					      GDestroyNotify destroy)
+{
+	g_warning ("custom sort functions are not supported");
+}
+
+static gboolean
+gpk_package_list_model_has_default_sort_func (GtkTreeSortable *sortable)
+{
+	return FALSE;
+}
+
+static void
+gpk_package_list_model_sortable_init (GtkTreeSortableIface *iface)
+{
+	iface->get_sort_column_id = gpk_package_list_model_get_sort_column_id;
+	iface->set_sort_column_id = gpk_package_list_model_set_sort_column_id;
+	iface->set_sort_func = gpk_package_list_model_set_sort_func;
+	iface->set_default_sort_func = gpk_package_list_model_set_default_sort_func;
+	iface->has_default_sort_func = gpk_package_list_model_has_default_sort_func;
+}
+
+static void
+gpk_package_list_model_style_changed_cb (GtkStyleContext *style, GpkPackageListModel *model)
+{
+	g_free (model->color);
+	model->color = gpk_style_context_get_inactive_color (style);
+}
+
+/**
+ * gpk_package_list_model_set_style_context:
+ *
+ * The style is used to find the color for the second line of the markup,
+ * which is only looked up again when the style changes.
+ **/
+void
+gpk_package_list_model_set_style_context (GpkPackageListModel *model, GtkStyleContext *style)
+{
+	g_return_if_fail (GPK_IS_PACKAGE_LIST_MODEL (model));
+
+	if (model->style != NULL)
+		g_signal_handlers_disconnect_by_data (model->style, model);
+	g_set_object (&model->style, style);
+	if (model->style != NULL) {
+		g_signal_connect (model->style, "changed",
+				  G_CALLBACK (gpk_package_list_model_style_changed_cb), model);
+	}
+	gpk_package_list_model_style_changed_cb (model->style, model);
+}
+
+/**
+ * gpk_package_list_model_append:
+ * @icon: a static string, which is not copied
+ *
+ * Adds a package row, or inserts it in order if the model is sorted.
+ **/
+void
+gpk_package_list_model_append (GpkPackageListModel *model,
+			       GtkTreeIter *iter,
+			       const gchar *package_id,
+			       const gchar *summary,
+			       PkBitfield state,
+			       gboolean checkbox,
+			       gboolean checkbox_visible,
+			       const gchar *icon)
+{
+	GpkPackageListItem item;
+	GpkPackageIdView view;
+	GpkStringPool *pool = gpk_string_pool_get_default ();
+	const gchar *tmp;
+	guint len;
+
+	g_return_if_fail (GPK_IS_PACKAGE_LIST_MODEL (model));
+	g_return_if_fail (package_id != NULL);
+
+	if (!gpk_package_id_view_parse (&view, package_id)) {
+		g_warning ("invalid package-id %s", package_id);
+		return;
+	}
+
+	tmp = gpk_package_id_view_get (&view, PK_PACKAGE_ID_NAME, &len);
+	item.name = g_string_chunk_insert_len (model->arena, tmp, len);
+	tmp = gpk_package_id_view_get (&view, PK_PACKAGE_ID_VERSION, &len);
+	item.version = g_string_chunk_insert_len (model->arena, tmp, len);
+	tmp = gpk_package_id_view_get (&view, PK_PACKAGE_ID_ARCH, &len);
+	item.arch = gpk_string_pool_intern_len (pool, tmp, len);
+	tmp = gpk_package_id_view_get (&view, PK_PACKAGE_ID_DATA, &len);
+	item.data = gpk_string_pool_intern_len (pool, tmp, len);
+	item.summary = summary != NULL ? g_string_chunk_insert (model->arena, summary) : NULL;
+	item.icon = icon;
+	item.state = state;
+	item.checkbox = checkbox;
+	item.checkbox_visible = checkbox_visible;
+	gpk_package_list_model_insert_item (model, &item, iter);
+}
+
+/**
+ * gpk_package_list_model_append_message:
+ * @icon: a static string, which is not copied
+ *
+ * Adds a row that has no package, for instance a search hint.
+ **/
+void
+gpk_package_list_model_append_message (GpkPackageListModel *model,
+				       GtkTreeIter *iter,
+				       const gchar *icon,
+				       const gchar *text)
+{
+	GpkPackageListItem item = { NULL };
+
+	g_return_if_fail (GPK_IS_PACKAGE_LIST_MODEL (model));
+
+	item.summary = g_string_chunk_insert (model->arena, text);
+	item.icon = icon;
+	gpk_package_list_model_insert_item (model, &item, iter);
+}
+
+/**
+ * gpk_package_list_model_set_state:
+ **/
+void
+gpk_package_list_model_set_state (GpkPackageListModel *model,
+				  GtkTreeIter *iter,
+				  PkBitfield state,
+				  gboolean checkbox,
+				  const gchar *icon)
+{
+	GpkPackageListItem *item;
+
+	g_return_if_fail (GPK_IS_PACKAGE_LIST_MODEL (model));
+
+	item = gpk_package_list_model_get_item_for_iter (model, iter);
+	if (item == NULL)
+		return;
+	item->state = state;
+	item->checkbox = checkbox;
+	item->icon = icon;
+	gpk_package_list_model_row_changed (model, iter);
+}
+
+/**
+ * gpk_package_list_model_set_checkbox_visible:
+ **/
+void
+gpk_package_list_model_set_checkbox_visible (GpkPackageListModel *model,
+					     GtkTreeIter *iter,
+					     gboolean checkbox_visible)
+{
+	GpkPackageListItem *item;
+
+	g_return_if_fail (GPK_IS_PACKAGE_LIST_MODEL (model));
+
+	item = gpk_package_list_model_get_item_for_iter (model, iter);
+	if (item == NULL)
+		return;
+	if (item->checkbox_visible == (checkbox_visible != FALSE))
+		return;
+	item->checkbox_visible = checkbox_visible;
+	gpk_package_list_model_row_changed (model, iter);
+}
+
+/**
+ * gpk_package_list_model_clear:
+ **/
+void
+gpk_package_list_model_clear (GpkPackageListModel *model)
+{
+	GtkTreePath *path;
+
+	g_return_if_fail (GPK_IS_PACKAGE_LIST_MODEL (model));
+
+	/* remove from the end so no row has to move */
+	while (model->order->len > 0) {
+		g_array_set_size (model->order, model->order->len - 1);
+		path = gtk_tree_path_new_from_indices (model->order->len, -1);
+		gtk_tree_model_row_deleted (GTK_TREE_MODEL (model), path);
+		gtk_tree_path_free (path);
+	}
+	g_array_set_size (model->items, 0);
+	g_string_chunk_clear (model->arena);
+	model->stamp++;
+}
+
+/**
+ * gpk_package_list_model_get_size:
+ **/
+guint
+gpk_package_list_model_get_size (GpkPackageListModel *model)
+{
+	g_return_val_if_fail (GPK_IS_PACKAGE_LIST_MODEL (model), 0);
+	return model->order->len;
+}
+
+static void
+gpk_package_list_model_finalize (GObject *object)
+{
+	GpkPackageListModel *model = GPK_PACKAGE_LIST_MODEL (object);
+
+	g_array_unref (model->items);
+	g_array_unref (model->order);
+	g_string_chunk_free (model->arena);
+	if (model->style != NULL) {
+		g_signal_handlers_disconnect_by_data (model->style, model);
+		g_object_unref (model->style);
+	}
+	g_free (model->color);
+
+	G_OBJECT_CLASS (gpk_package_list_model_parent_class)->finalize (object);
+}
+
+static void
+gpk_package_list_model_class_init (GpkPackageListModelClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	object_class->finalize = gpk_package_list_model_finalize;
+}
+
+static void
+gpk_package_list_model_init (GpkPackageListModel *model)
+{
+	model->items = g_array_new (FALSE, FALSE, sizeof (GpkPackageListItem));
+	model->order = g_array_new (FALSE, FALSE, sizeof (guint));
+	model->arena = g_string_chunk_new (64 * 1024);
+	model->color = gpk_style_context_get_inactive_color (NULL);
+	model->stamp = g_random_int ();
+	model->sort_column_id = GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID;
+	model->sort_order = GTK_SORT_ASCENDING;
+}
+
+/**
+ * gpk_package_list_model_new:
+ **/
+GpkPackageListModel *
+gpk_package_list_model_new (void)
+{
+	return g_object_new (GPK_TYPE_PACKAGE_LIST_MODEL, NULL);
+}
@@ -0,0 +1,74 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef GPK_PACKAGE_LIST_MODEL_H
+#define GPK_PACKAGE_LIST_MODEL_H
+
+#include <glib-object.h>
+#include <gtk/gtk.h>
+#include <packagekit-glib2/packagekit.h>
+
+G_BEGIN_DECLS
+
+typedef enum {
+	GPK_PACKAGE_LIST_COLUMN_IMAGE,
+	GPK_PACKAGE_LIST_COLUMN_STATE,		/* state of the item */
+	GPK_PACKAGE_LIST_COLUMN_CHECKBOX,	/* what we show in the checkbox */
+	GPK_PACKAGE_LIST_COLUMN_CHECKBOX_VISIBLE, /* visible */
+	GPK_PACKAGE_LIST_COLUMN_TEXT,
+	GPK_PACKAGE_LIST_COLUMN_ID,
+	GPK_PACKAGE_LIST_COLUMN_SUMMARY,
+	GPK_PACKAGE_LIST_COLUMN_LAST
+} GpkPackageListColumn;
+
+#define GPK_TYPE_PACKAGE_LIST_MODEL (gpk_package_list_model_get_type())
+G_DECLARE_FINAL_TYPE (GpkPackageListModel, gpk_package_list_model, GPK, PACKAGE_LIST_MODEL, GObject)
+
+GType			 gpk_package_list_model_get_type	(void);
+GpkPackageListModel	*gpk_package_list_model_new		(void);
+void			 gpk_package_list_model_set_style_context (GpkPackageListModel *model,
+								 GtkStyleContext *style);
+void			 gpk_package_list_model_append		(GpkPackageListModel *model,
+								 GtkTreeIter	*iter,
+								 const gchar	*package_id,
+								 const gchar	*summary,
+								 PkBitfield	 state,
+								 gboolean	 checkbox,
+								 gboolean	 checkbox_visible,
+								 const gchar	*icon);
+void			 gpk_package_list_model_append_message	(GpkPackageListModel *model,
+								 GtkTreeIter	*iter,
+								 const gchar	*icon,
+								 const gchar	*text);
+void			 gpk_package_list_model_set_state	(GpkPackageListModel *model,
+								 GtkTreeIter	*iter,
+								 PkBitfield	 state,
+								 gboolean	 checkbox,
+								 const gchar	*icon);
+void			 gpk_package_list_model_set_checkbox_visible (GpkPackageListModel *model,
+								 GtkTreeIter	*iter,
+								 gboolean	 checkbox_visible);
+void			 gpk_package_list_model_clear		(GpkPackageListModel *model);
+guint			 gpk_package_list_model_get_size	(GpkPackageListModel *model);
+
+G_END_DECLS
+
+#endif /* GPK_PACKAGE_LIST_MODEL_H */
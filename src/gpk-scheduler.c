@@ -0,0 +1,350 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include "gpk-scheduler.h"
+
+typedef struct {
+	GpkScheduler		*scheduler;
+	GpkSchedulerPriority	 priority;
+	gchar			*kind;
+	gchar			*key;
+	GCancellable		*cancellable;
+	GpkSchedulerFunc	 func;
+	GAsyncReadyCallback	 callback;
+	gpointer		 user_data;
+	gboolean		 running;
+} GpkSchedulerRequest;
+
+struct _GpkScheduler
+{
+	GObject			 parent_instance;
+	GPtrArray		*requests;	/* of GpkSchedulerRequest, oldest first */
+	guint			 started;
+	guint			 coalesced;
+};
+
+G_DEFINE_TYPE (GpkScheduler, gpk_scheduler, G_TYPE_OBJECT)
+
+static void
+gpk_scheduler_request_free (GpkSchedulerRequest *request)
+{
+	g_object_unref (request->scheduler);
+	g_object_unref (request->cancellable);
+	g_free (request->kind);
+	g_free (request->key);
+	g_free (request);
+}
+
+static gboolean
+gpk_scheduler_request_is_active (GpkSchedulerRequest *request)
+{
+	return !g_cancellable_is_cancelled (request->cancellable);
+}
+
+static void gpk_scheduler_run (GpkScheduler *scheduler);
+
+static void
+gpk_scheduler_ready_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	GpkSchedulerRequest *request = user_data;
+	GpkScheduler *scheduler = request->scheduler;
+
+	/* anything added from the callback is not a duplicate of this */
+	g_ptr_array_remove (scheduler->requests, request);
+	if (request->callback != NULL)
+		request->callback (source, res, request->user_data);
+
+	/* something waiting for this might be able to go now */
+	gpk_scheduler_run (scheduler);
+	gpk_scheduler_request_free (request);
+}
+
+static void
+gpk_scheduler_start (GpkScheduler *scheduler, GpkSchedulerRequest *request)
+{
+	g_debug ("starting %s request %s", request->kind,
+		 request->key != NULL ? request->key : "");
+	request->running = TRUE;
+	scheduler->started++;
+	request->func (request->key, request->cancellable,
+		       gpk_scheduler_ready_cb, request,
+		       request->user_data);
+}
+
+static void
+gpk_scheduler_run (GpkScheduler *scheduler)
+{
+	GpkSchedulerRequest *request;
+	GpkSchedulerRequest *best;
+	gint priority = -1;
+	guint i;
+
+	/* nothing can start below what is already running */
+	for (i = 0; i < scheduler->requests->len; i++) {
+		request = g_ptr_array_index (scheduler->requests, i);
+		if (request->running && gpk_scheduler_request_is_active (request))
+			priority = MAX (priority, (gint) request->priority);
+	}
+
+	/* start the most important first, oldest first if the same */
+	do {
+		best = NULL;
+		for (i = 0; i < scheduler->requests->len; i++) {
+			request = g_ptr_array_index (scheduler->requests, i);
+			if (request->running)
+				continue;
+			if (best == NULL || request->priority > best->priority)
+				best = request;
+		}
+		if (best == NULL || (gint) best->priority < priority)
+			break;
+		priority = MAX (priority, (gint) best->priority);
+		gpk_scheduler_start (scheduler, best);
+	} while (TRUE);
+}
+
+static void
+gpk_scheduler_cancel_requests (GpkScheduler *scheduler, GPtrArray *requests)
+{
+	GpkSchedulerRequest *request;
+	guint i;
+
+	for (i = 0; i < requests->len; i++) {
+		request = g_ptr_array_index (requests, i);
+		g_debug ("cancelling %s request %s", request->kind,
+			 request->key != NULL ? request->key : "");
+		g_cancellable_cancel (request->cancellable);
+
+		/* the callback is always run, so start it to get the error */
+		if (!request->running)
+			gpk_scheduler_start (scheduler, request);
+	}
+}
+
+/**
+ * gpk_scheduler_cancel:
+ *
+ * Cancels all requests of @kind.
+ **/
+void
+gpk_scheduler_cancel (GpkScheduler *scheduler, const gchar *kind)
+{
+	GpkSchedulerRequest *request;
+	guint i;
+	g_autoptr(GPtrArray) requests = NULL;
+
+	g_return_if_fail (GPK_IS_SCHEDULER (scheduler));
+	g_return_if_fail (kind != NULL);
+
+	requests = g_ptr_array_new ();
+	for (i = 0; i < scheduler->requests->len; i++) {
+		request = g_ptr_array_index (scheduler->requests, i);
+		if (gpk_scheduler_request_is_active (request) &&
+		    g_strcmp0 (request->kind, kind) == 0)
+			g_ptr_array_add (requests, request);
+	}
+	gpk_scheduler_cancel_requests (scheduler, requests);
+}
+
+/**
+ * gpk_scheduler_cancel_priority:
+ *
+ * Cancels all requests of @priority.
+ **/
+void
+gpk_scheduler_cancel_priority (GpkScheduler *scheduler, GpkSchedulerPriority priority)
+{
+	GpkSchedulerRequest *request;
+	guint i;
+	g_autoptr(GPtrArray) requests = NULL;
+
+	g_return_if_fail (GPK_IS_SCHEDULER (scheduler));
+
+	requests = g_ptr_array_new ();
+	for (i = 0; i < scheduler->requests->len; i++) {
+		request = g_ptr_array_index (scheduler->requests, i);
+		if (gpk_scheduler_request_is_active (request) &&
+		    request->priority == priority)
+			g_ptr_array_add (requests, request);
+	}
+	gpk_scheduler_cancel_requests (scheduler, requests);
+}
+
+/**
+ * gpk_scheduler_cancel_all:
+ **/
+void
+gpk_scheduler_cancel_all (GpkScheduler *scheduler)
+{
+	guint i;
+
+	g_return_if_fail (GPK_IS_SCHEDULER (scheduler));
+
+	for (i = 0; i < GPK_SCHEDULER_PRIORITY_LAST; i++)
+		gpk_scheduler_cancel_priority (scheduler, i);
+}
+
+/**
+ * gpk_scheduler_contains:
+ *
+ * Return value: %TRUE if an identical request has not yet finished
+ **/
+gboolean
+gpk_scheduler_contains (GpkScheduler *scheduler, const gchar *kind, const gchar *key)
+{
+	GpkSchedulerRequest *request;
+	guint i;
+
+	g_return_val_if_fail (GPK_IS_SCHEDULER (scheduler), FALSE);
+
+	for (i = 0; i < scheduler->requests->len; i++) {
+		request = g_ptr_array_index (scheduler->requests, i);
+		if (gpk_scheduler_request_is_active (request) &&
+		    g_strcmp0 (request->kind, kind) == 0 &&
+		    g_strcmp0 (request->key, key) == 0)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+/**
+ * gpk_scheduler_add:
+ * @scheduler: a #GpkScheduler
+ * @priority: a #GpkSchedulerPriority
+ * @kind: the type of request, e.g. "details"
+ * @key: what is being requested, e.g. a package ID
+ * @func: the function that starts the request
+ * @callback: called when the request has finished
+ * @user_data: passed to @func and @callback
+ *
+ * Schedules a request, which is started with its own #GCancellable once
+ * nothing more important is running. Any earlier request of the same
+ * @kind is cancelled, and interactive requests also cancel any prefetch.
+ *
+ * If an identical request is already scheduled then nothing is done, and
+ * @callback will not be called. Otherwise @callback is always called,
+ * even if the request is cancelled before it was started.
+ *
+ * Return value: %FALSE if the request was a duplicate
+ **/
+gboolean
+gpk_scheduler_add (GpkScheduler *scheduler,
+		   GpkSchedulerPriority priority,
+		   const gchar *kind,
+		   const gchar *key,
+		   GpkSchedulerFunc func,
+		   GAsyncReadyCallback callback,
+		   gpointer user_data)
+{
+	GpkSchedulerRequest *request;
+
+	g_return_val_if_fail (GPK_IS_SCHEDULER (scheduler), FALSE);
+	g_return_val_if_fail (priority < GPK_SCHEDULER_PRIORITY_LAST, FALSE);
+	g_return_val_if_fail (kind != NULL, FALSE);
+	g_return_val_if_fail (func != NULL, FALSE);
+
+	/* already asked */
+	if (gpk_scheduler_contains (scheduler, kind, key)) {
+		g_debug ("already scheduled %s request %s", kind,
+			 key != NULL ? key : "");
+		scheduler->coalesced++;
+		return FALSE;
+	}
+
+	/* this replaces whatever was asked for before */
+	gpk_scheduler_cancel (scheduler, kind);
+
+	/* the user is waiting for this, so guesses can be made again later */
+	if (priority == GPK_SCHEDULER_PRIORITY_INTERACTIVE)
+		gpk_scheduler_cancel_priority (scheduler, GPK_SCHEDULER_PRIORITY_PREFETCH);
+
+	request = g_new0 (GpkSchedulerRequest, 1);
+	request->scheduler = g_object_ref (scheduler);
+	request->priority = priority;
+	request->kind = g_strdup (kind);
+	request->key = g_strdup (key);
+	request->cancellable = g_cancellable_new ();
+	request->func = func;
+	request->callback = callback;
+	request->user_data = user_data;
+	g_ptr_array_add (scheduler->requests, request);
+	gpk_scheduler_run (scheduler);
+	return TRUE;
+}
+
+/**
+ * gpk_scheduler_get_started:
+ **/
+guint
+gpk_scheduler_get_started (GpkScheduler *scheduler)
+{
+	g_return_val_if_fail (GPK_IS_SCHEDULER (scheduler), 0);
+	return scheduler->started;
+}
+
+/**
+ * gpk_scheduler_get_coalesced:
+ *
+ * Return value: the number of requests that were duplicates
+ **/
+guint
+gpk_scheduler_get_coalesced (GpkScheduler *scheduler)
+{
+	g_return_val_if_fail (GPK_IS_SCHEDULER (scheduler), 0);
+	return scheduler->coalesced;
+}
+
+static void
+gpk_scheduler_finalize (GObject *object)
+{
+	GpkScheduler *scheduler = GPK_SCHEDULER (object);
+
+	/* every request holds a reference */
+	g_ptr_array_unref (scheduler->requests);
+
+	G_OBJECT_CLASS (gpk_scheduler_parent_class)->finalize (object);
+}
+
+static void
+gpk_scheduler_class_init (GpkSchedulerClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	object_class->finalize = gpk_scheduler_finalize;
+}
+
+static void
+gpk_scheduler_init (GpkScheduler *scheduler)
+{
+	scheduler->requests = g_ptr_array_new ();
+}
+
+/**
+ * gpk_scheduler_new:
+ **/
+GpkScheduler *
+gpk_scheduler_new (void)
+{
+	return g_object_new (GPK_TYPE_SCHEDULER, NULL);
+}
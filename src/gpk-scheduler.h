@@ -0,0 +1,68 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef GPK_SCHEDULER_H
+#define GPK_SCHEDULER_H
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define GPK_TYPE_SCHEDULER (gpk_scheduler_get_type())
+G_DECLARE_FINAL_TYPE (GpkScheduler, gpk_scheduler, GPK, SCHEDULER, GObject)
+
+typedef enum {
+	GPK_SCHEDULER_PRIORITY_BACKGROUND,
+	GPK_SCHEDULER_PRIORITY_PREFETCH,
+	GPK_SCHEDULER_PRIORITY_INTERACTIVE,
+	GPK_SCHEDULER_PRIORITY_LAST
+} GpkSchedulerPriority;
+
+/* starts the request, which must call @callback with @callback_data */
+typedef void	(*GpkSchedulerFunc)		(const gchar	*key,
+						 GCancellable	*cancellable,
+						 GAsyncReadyCallback callback,
+						 gpointer	 callback_data,
+						 gpointer	 user_data);
+
+GType		 gpk_scheduler_get_type		(void);
+GpkScheduler	*gpk_scheduler_new		(void);
+gboolean	 gpk_scheduler_add		(GpkScheduler	*scheduler,
+						 GpkSchedulerPriority priority,
+						 const gchar	*kind,
+						 const gchar	*key,
+						 GpkSchedulerFunc func,
+						 GAsyncReadyCallback callback,
+						 gpointer	 user_data);
+gboolean	 gpk_scheduler_contains		(GpkScheduler	*scheduler,
+						 const gchar	*kind,
+						 const gchar	*key);
+void		 gpk_scheduler_cancel		(GpkScheduler	*scheduler,
+						 const gchar	*kind);
+void		 gpk_scheduler_cancel_priority	(GpkScheduler	*scheduler,
+						 GpkSchedulerPriority priority);
+void		 gpk_scheduler_cancel_all	(GpkScheduler	*scheduler);
+guint		 gpk_scheduler_get_started	(GpkScheduler	*scheduler);
+guint		 gpk_scheduler_get_coalesced	(GpkScheduler	*scheduler);
+
+G_END_DECLS
+
+#endif /* GPK_SCHEDULER_H */
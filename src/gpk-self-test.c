@@ -19,12 +19,27 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include "config.h"
+
 #include <glib.h>
 #include <glib-object.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#ifdef HAVE_MALLINFO2
+#include <malloc.h>
+#endif
 
 #include "gpk-common.h"
+#include "gpk-details-cache.h"
 #include "gpk-enum.h"
+#include "gpk-enum-private.h"
 #include "gpk-error.h"
+#include "gpk-log-index.h"
+#include "gpk-markup-formatter.h"
+#include "gpk-package-cache.h"
+#include "gpk-package-list-model.h"
+#include "gpk-scheduler.h"
+#include "gpk-string-pool.h"
 #include "gpk-task.h"
 
 
@@ -179,6 +194,60 @@ gpk_test_enum_func (void)
 		}
 	}
 
+	/* check the tables give the same strings as the switches */
+	for (i = 0; i < PK_STATUS_ENUM_LAST; i++) {
+		string = gpk_status_enum_to_localised_text_real (i);
+		if (string != NULL)
+			g_assert_cmpstr (gpk_status_enum_to_localised_text (i), ==, string);
+	}
+	for (i = 0; i < PK_INFO_ENUM_LAST; i++) {
+		string = gpk_info_enum_to_localised_text_real (i);
+		if (string != NULL)
+			g_assert_cmpstr (gpk_info_enum_to_localised_text (i), ==, string);
+		string = gpk_info_enum_to_localised_present_real (i);
+		if (string != NULL)
+			g_assert_cmpstr (gpk_info_status_enum_to_string (i), ==, string);
+		string = gpk_info_enum_to_localised_past_real (i);
+		if (string != NULL)
+			g_assert_cmpstr (gpk_info_enum_to_localised_past (i), ==, string);
+	}
+	for (i = 0; i < PK_ROLE_ENUM_LAST; i++) {
+		string = gpk_role_enum_to_localised_past_real (i);
+		if (string != NULL)
+			g_assert_cmpstr (gpk_role_enum_to_localised_past (i), ==, string);
+	}
+	for (i = 0; i < PK_GROUP_ENUM_LAST; i++) {
+		string = gpk_group_enum_to_localised_text_real (i);
+		if (string != NULL)
+			g_assert_cmpstr (gpk_group_enum_to_localised_text (i), ==, string);
+	}
+
+	/* values out of range use the first icon */
+	g_assert_cmpstr (gpk_info_enum_to_icon_name (PK_INFO_ENUM_LAST), ==, "help-browser");
+	g_assert_cmpstr (gpk_status_enum_to_icon_name (PK_STATUS_ENUM_LAST + 1), ==, "help-browser");
+	g_assert_cmpstr (gpk_role_enum_to_icon_name (PK_ROLE_ENUM_LAST), ==, "help-browser");
+	g_assert_cmpstr (gpk_group_enum_to_icon_name (PK_GROUP_ENUM_LAST), ==, "help-browser");
+}
+
+static void
+gpk_test_enum_icons_func (void)
+{
+	const gchar *table[4];
+	const PkEnumMatch match[] = {
+		{ 0,	"fallback" },
+		{ 2,	"first" },
+		{ 7,	"too-big" },
+		{ 2,	"second" },
+		{ 3,	"three" },
+		{ 0,	NULL }
+	};
+
+	/* the first match wins, and missing values use the fallback */
+	gpk_enum_icons_fill (table, G_N_ELEMENTS (table), match);
+	g_assert_cmpstr (table[0], ==, "fallback");
+	g_assert_cmpstr (table[1], ==, "fallback");
+	g_assert_cmpstr (table[2], ==, "first");
+	g_assert_cmpstr (table[3], ==, "three");
 }
 
 static void
@@ -197,7 +266,11 @@ gpk_test_error_func (void)
 static void
 gpk_test_common_func (void)
 {
+	gboolean ret;
 	gchar *text;
+	const gchar *tmp;
+	guint len;
+	GpkPackageIdView view;
 
 	/* time zero */
 	text = gpk_time_to_localised_string (0);
@@ -273,6 +346,896 @@ gpk_test_common_func (void)
 	text = gpk_package_id_format_twoline (NULL, "simon;0.0.1;;data", "dude");
 	g_assert_cmpstr (text, ==, "dude\n<span color=\"gray\">simon-0.0.1</span>");
 	g_free (text);
+
+	/* package id views */
+	ret = gpk_package_id_view_parse (&view, "simon;0.0.1;x86_64;installed:fedora");
+	g_assert (ret);
+	tmp = gpk_package_id_view_get (&view, PK_PACKAGE_ID_ARCH, &len);
+	g_assert_cmpint (len, ==, 6);
+	g_assert (strncmp (tmp, "x86_64", len) == 0);
+	g_assert (gpk_package_id_view_equal (&view, PK_PACKAGE_ID_NAME, "simon"));
+	g_assert (!gpk_package_id_view_equal (&view, PK_PACKAGE_ID_NAME, "sim"));
+	g_assert (!gpk_package_id_view_equal (&view, PK_PACKAGE_ID_NAME, "simons"));
+	g_assert (gpk_package_id_view_contains (&view, PK_PACKAGE_ID_VERSION, "0.1"));
+	g_assert (!gpk_package_id_view_contains (&view, PK_PACKAGE_ID_VERSION, "x86"));
+	text = gpk_package_id_view_dup (&view, PK_PACKAGE_ID_DATA);
+	g_assert_cmpstr (text, ==, "installed:fedora");
+	g_free (text);
+	ret = gpk_package_id_view_parse (&view, "simon;;;");
+	g_assert (ret);
+	g_assert_cmpint (view.len[PK_PACKAGE_ID_DATA], ==, 0);
+	g_assert (!gpk_package_id_view_parse (&view, ";0.0.1;;data"));
+	g_assert (!gpk_package_id_view_parse (&view, "simon;0.0.1;data"));
+	g_assert (!gpk_package_id_view_parse (&view, "simon;0.0.1;;data;"));
+	g_assert (!gpk_package_id_view_parse (&view, NULL));
+}
+
+static void
+gpk_test_package_list_model_func (void)
+{
+	GtkTreeIter iter;
+	GtkTreeModel *model_tree;
+	PkBitfield state = 0;
+	gchar *package_id;
+	gchar *text;
+	g_autoptr(GpkPackageListModel) model = NULL;
+
+	model = gpk_package_list_model_new ();
+	model_tree = GTK_TREE_MODEL (model);
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (model),
+					      GPK_PACKAGE_LIST_COLUMN_ID,
+					      GTK_SORT_ASCENDING);
+
+	/* rows are inserted in order */
+	gpk_package_list_model_append (model, NULL, "zebra;1.0;i386;fedora", "Stripes",
+				       0, FALSE, TRUE, "pk-package-available");
+	gpk_package_list_model_append (model, NULL, "apple;2.0;;fedora", NULL,
+				       0, FALSE, TRUE, "pk-package-available");
+	gpk_package_list_model_append_message (model, NULL, "system-search", "No results");
+	g_assert_cmpint (gpk_package_list_model_get_size (model), ==, 3);
+
+	/* message rows have no ID and sort first */
+	g_assert (gtk_tree_model_get_iter_first (model_tree, &iter));
+	gtk_tree_model_get (model_tree, &iter,
+			    GPK_PACKAGE_LIST_COLUMN_ID, &package_id,
+			    GPK_PACKAGE_LIST_COLUMN_TEXT, &text,
+			    -1);
+	g_assert_cmpstr (package_id, ==, NULL);
+	g_assert_cmpstr (text, ==, "No results");
+	g_free (text);
+
+	/* the ID is rebuilt from the parts */
+	g_assert (gtk_tree_model_iter_next (model_tree, &iter));
+	gtk_tree_model_get (model_tree, &iter,
+			    GPK_PACKAGE_LIST_COLUMN_ID, &package_id,
+			    GPK_PACKAGE_LIST_COLUMN_TEXT, &text,
+			    -1);
+	g_assert_cmpstr (package_id, ==, "apple;2.0;;fedora");
+	g_assert_cmpstr (text, ==, "apple-2.0");
+	g_free (package_id);
+	g_free (text);
+
+	/* the markup is generated when read */
+	g_assert (gtk_tree_model_iter_next (model_tree, &iter));
+	gtk_tree_model_get (model_tree, &iter,
+			    GPK_PACKAGE_LIST_COLUMN_TEXT, &text,
+			    -1);
+	g_assert_cmpstr (text, ==, "Stripes\n<span color=\"gray\">zebra-1.0 (32-bit)</span>");
+	g_free (text);
+
+	/* change the state */
+	gpk_package_list_model_set_state (model, &iter, 1, TRUE, "pk-package-installed");
+	gtk_tree_model_get (model_tree, &iter,
+			    GPK_PACKAGE_LIST_COLUMN_STATE, &state,
+			    -1);
+	g_assert_cmpint (state, ==, 1);
+	g_assert (!gtk_tree_model_iter_next (model_tree, &iter));
+
+	/* reverse the order */
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (model),
+					      GPK_PACKAGE_LIST_COLUMN_ID,
+					      GTK_SORT_DESCENDING);
+	g_assert (gtk_tree_model_get_iter_first (model_tree, &iter));
+	gtk_tree_model_get (model_tree, &iter,
+			    GPK_PACKAGE_LIST_COLUMN_ID, &package_id,
+			    -1);
+	g_assert_cmpstr (package_id, ==, "zebra;1.0;i386;fedora");
+	g_free (package_id);
+
+	gpk_package_list_model_clear (model);
+	g_assert_cmpint (gpk_package_list_model_get_size (model), ==, 0);
+	g_assert (!gtk_tree_model_get_iter_first (model_tree, &iter));
+}
+
+static PkCategory *
+gpk_test_category_new (const gchar *parent_id, const gchar *cat_id)
+{
+	PkCategory *item = pk_category_new ();
+	g_object_set (item,
+		      "parent-id", parent_id,
+		      "cat-id", cat_id,
+		      "name", cat_id,
+		      NULL);
+	return item;
+}
+
+static void
+gpk_test_category_tree_func (void)
+{
+	GNode *node;
+	GNode *tree;
+	guint i;
+	g_autoptr(GPtrArray) array = NULL;
+	g_autoptr(GTimer) timer = g_timer_new ();
+
+	/* children before parents, an orphan and a loop */
+	array = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_ptr_array_add (array, gpk_test_category_new ("apps", "apps-games"));
+	g_ptr_array_add (array, gpk_test_category_new ("apps-games", "apps-games-arcade"));
+	g_ptr_array_add (array, gpk_test_category_new (NULL, "apps"));
+	g_ptr_array_add (array, gpk_test_category_new ("missing", "orphan"));
+	g_ptr_array_add (array, gpk_test_category_new ("loop-b", "loop-a"));
+	g_ptr_array_add (array, gpk_test_category_new ("loop-a", "loop-b"));
+	g_ptr_array_add (array, gpk_test_category_new ("apps", "apps-office"));
+	tree = gpk_category_array_to_tree (array);
+	g_assert_cmpint (g_node_n_children (tree), ==, 2);
+	g_assert_cmpint (g_node_n_nodes (tree, G_TRAVERSE_ALL), ==, 6);
+	g_assert_cmpint (g_node_max_height (tree), ==, 4);
+	node = g_node_first_child (tree);
+	g_assert_cmpstr (pk_category_get_id (node->data), ==, "apps");
+	g_assert_cmpstr (pk_category_get_id (g_node_first_child (node)->data), ==, "apps-games");
+	g_assert_cmpstr (pk_category_get_id (g_node_last_child (node)->data), ==, "apps-office");
+	node = g_node_next_sibling (node);
+	g_assert_cmpstr (pk_category_get_id (node->data), ==, "orphan");
+	g_node_destroy (tree);
+	g_ptr_array_unref (array);
+
+	/* 100 top level groups, three layers deep */
+	array = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	for (i = 0; i < 10000; i++) {
+		g_autofree gchar *cat_id = g_strdup_printf ("cat%u", i);
+		g_autofree gchar *parent_id = NULL;
+		if (i >= 100)
+			parent_id = g_strdup_printf ("cat%u", i / 10);
+		g_ptr_array_add (array, gpk_test_category_new (parent_id, cat_id));
+	}
+	g_timer_reset (timer);
+	tree = gpk_category_array_to_tree (array);
+	g_test_message ("built tree of %u categories in %.1fms",
+			array->len, g_timer_elapsed (timer, NULL) * 1000.f);
+	g_assert_cmpint (g_node_n_children (tree), ==, 100);
+	g_assert_cmpint (g_node_n_nodes (tree, G_TRAVERSE_ALL), ==, 10001);
+	g_assert_cmpint (g_node_max_height (tree), ==, 4);
+	node = g_node_nth_child (tree, 10);
+	g_assert_cmpstr (pk_category_get_id (node->data), ==, "cat10");
+	g_assert_cmpint (g_node_n_children (node), ==, 10);
+	g_assert_cmpstr (pk_category_get_id (g_node_first_child (node)->data), ==, "cat100");
+	g_assert_cmpstr (pk_category_get_id (g_node_last_child (node)->data), ==, "cat109");
+	node = g_node_first_child (g_node_last_child (node));
+	g_assert_cmpstr (pk_category_get_id (node->data), ==, "cat1090");
+	g_node_destroy (tree);
+}
+
+static PkPackage *
+gpk_test_package_new (const gchar *package_id, PkInfoEnum info, const gchar *summary)
+{
+	PkPackage *package = pk_package_new ();
+	gboolean ret;
+	ret = pk_package_set_id (package, package_id, NULL);
+	g_assert (ret);
+	g_object_set (package, "info", info, "summary", summary, NULL);
+	return package;
+}
+
+static void
+gpk_test_package_cache_func (void)
+{
+	PkBitfield filters = pk_bitfield_value (PK_FILTER_ENUM_NEWEST);
+	PkPackage *package;
+	gboolean ret;
+	g_autofree gchar *filename = NULL;
+	g_autofree gchar *tmpdir = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) all = NULL;
+	g_autoptr(GPtrArray) array = NULL;
+	g_autoptr(GPtrArray) games = NULL;
+	g_autoptr(GpkPackageCache) cache = NULL;
+	g_auto(GStrv) values = g_strsplit ("HELLO", " ", -1);
+
+	tmpdir = g_dir_make_tmp ("gpk-self-test-XXXXXX", &error);
+	g_assert_no_error (error);
+	filename = g_build_filename (tmpdir, "cache", "packages.cache", NULL);
+
+	/* nothing known yet */
+	cache = gpk_package_cache_new (filename);
+	ret = gpk_package_cache_load (cache, &error);
+	g_assert (!ret);
+	g_clear_error (&error);
+	g_assert (gpk_package_cache_get_packages (cache, filters, NULL) == NULL);
+
+	/* add a group and then everything */
+	games = g_ptr_array_new_with_free_func (g_object_unref);
+	g_ptr_array_add (games, gpk_test_package_new ("supertux;0.4;x86_64;fedora",
+						      PK_INFO_ENUM_AVAILABLE, "Jump and run"));
+	g_assert (gpk_package_cache_add_packages (cache, filters, "games", games));
+	g_assert (!gpk_package_cache_add_packages (cache, filters, "games", games));
+	g_assert (!gpk_package_cache_has_packages (cache, filters, NULL));
+	all = g_ptr_array_new_with_free_func (g_object_unref);
+	g_ptr_array_add (all, gpk_test_package_new ("hello;2.10;x86_64;installed",
+						    PK_INFO_ENUM_INSTALLED, "Says hello"));
+	g_ptr_array_add (all, gpk_test_package_new ("supertux;0.4;x86_64;fedora",
+						    PK_INFO_ENUM_AVAILABLE, "Jump and run"));
+	g_assert (gpk_package_cache_add_packages (cache, filters, NULL, all));
+	g_assert (!gpk_package_cache_add_packages (cache, filters, NULL, all));
+	g_assert (gpk_package_cache_get_dirty (cache));
+
+	/* different filters are not used */
+	g_assert (gpk_package_cache_get_packages (cache, 0, NULL) == NULL);
+
+	/* write it out and read it back */
+	ret = gpk_package_cache_save (cache, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+	g_assert (!gpk_package_cache_get_dirty (cache));
+	g_object_unref (cache);
+	cache = gpk_package_cache_new (filename);
+	ret = gpk_package_cache_load (cache, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+
+	array = gpk_package_cache_get_packages (cache, filters, NULL);
+	g_assert (array != NULL);
+	g_assert_cmpint (array->len, ==, 2);
+	g_ptr_array_unref (array);
+	array = gpk_package_cache_get_packages (cache, filters, "games");
+	g_assert (array != NULL);
+	g_assert_cmpint (array->len, ==, 1);
+	package = g_ptr_array_index (array, 0);
+	g_assert_cmpstr (pk_package_get_id (package), ==, "supertux;0.4;x86_64;fedora");
+	g_assert_cmpstr (pk_package_get_summary (package), ==, "Jump and run");
+	g_assert_cmpint (pk_package_get_info (package), ==, PK_INFO_ENUM_AVAILABLE);
+	g_ptr_array_unref (array);
+
+	/* names are matched without case */
+	array = gpk_package_cache_search_names (cache, filters, values);
+	g_assert (array != NULL);
+	g_assert_cmpint (array->len, ==, 1);
+	package = g_ptr_array_index (array, 0);
+	g_assert_cmpint (pk_package_get_info (package), ==, PK_INFO_ENUM_INSTALLED);
+	g_ptr_array_unref (array);
+
+	/* the summary is only used for details */
+	g_strfreev (values);
+	values = g_strsplit ("jump tux", " ", -1);
+	array = gpk_package_cache_search_names (cache, filters, values);
+	g_assert_cmpint (array->len, ==, 0);
+	g_ptr_array_unref (array);
+	array = gpk_package_cache_search_details (cache, filters, values);
+	g_assert_cmpint (array->len, ==, 1);
+	g_ptr_array_unref (array);
+
+	/* too short for the index */
+	g_strfreev (values);
+	values = g_strsplit ("e", " ", -1);
+	array = gpk_package_cache_search_names (cache, filters, values);
+	g_assert_cmpint (array->len, ==, 2);
+	g_ptr_array_unref (array);
+	g_strfreev (values);
+	values = g_strsplit ("hello", " ", -1);
+
+	/* a package was removed */
+	g_ptr_array_remove_index (all, 0);
+	g_assert (gpk_package_cache_add_packages (cache, filters, NULL, all));
+	array = gpk_package_cache_search_names (cache, filters, values);
+	g_assert_cmpint (array->len, ==, 0);
+	g_clear_pointer (&array, g_ptr_array_unref);
+
+	/* a corrupt file is not used */
+	ret = g_file_set_contents (filename, "GPKCACHE", -1, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+	ret = gpk_package_cache_load (cache, &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+	g_assert (!ret);
+	g_clear_error (&error);
+
+	/* the file goes away */
+	gpk_package_cache_invalidate (cache);
+	g_assert (!g_file_test (filename, G_FILE_TEST_EXISTS));
+	g_assert (gpk_package_cache_get_packages (cache, filters, "games") == NULL);
+	g_clear_object (&cache);
+	g_free (filename);
+	filename = g_build_filename (tmpdir, "cache", NULL);
+	g_rmdir (filename);
+	g_rmdir (tmpdir);
+}
+
+static gboolean
+gpk_test_scheduler_finish_cb (gpointer user_data)
+{
+	GTask *task = G_TASK (user_data);
+	if (!g_task_return_error_if_cancelled (task))
+		g_task_return_boolean (task, TRUE);
+	g_object_unref (task);
+	return FALSE;
+}
+
+static void
+gpk_test_scheduler_start (const gchar *key, GCancellable *cancellable,
+			  GAsyncReadyCallback callback, gpointer callback_data,
+			  gpointer user_data)
+{
+	GTask *task = g_task_new (NULL, cancellable, callback, callback_data);
+	g_task_set_task_data (task, g_strdup (key), g_free);
+	g_idle_add (gpk_test_scheduler_finish_cb, task);
+}
+
+static void
+gpk_test_scheduler_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	GPtrArray *done = (GPtrArray *) user_data;
+	const gchar *key = g_task_get_task_data (G_TASK (res));
+	g_autoptr(GError) error = NULL;
+
+	/* cancelled requests are marked with a '!' */
+	if (!g_task_propagate_boolean (G_TASK (res), &error))
+		g_ptr_array_add (done, g_strdup_printf ("%s!", key));
+	else
+		g_ptr_array_add (done, g_strdup (key));
+}
+
+static void
+gpk_test_scheduler_func (void)
+{
+	gboolean ret;
+	g_autoptr(GpkScheduler) scheduler = NULL;
+	g_autoptr(GPtrArray) done = NULL;
+
+	scheduler = gpk_scheduler_new ();
+	done = g_ptr_array_new_with_free_func (g_free);
+
+	/* the background request waits for the interactive one */
+	ret = gpk_scheduler_add (scheduler, GPK_SCHEDULER_PRIORITY_INTERACTIVE,
+				 "details", "a", gpk_test_scheduler_start,
+				 gpk_test_scheduler_cb, done);
+	g_assert (ret);
+	ret = gpk_scheduler_add (scheduler, GPK_SCHEDULER_PRIORITY_BACKGROUND,
+				 "refill", "all", gpk_test_scheduler_start,
+				 gpk_test_scheduler_cb, done);
+	g_assert (ret);
+	g_assert_cmpint (gpk_scheduler_get_started (scheduler), ==, 1);
+
+	/* the same again is merged */
+	ret = gpk_scheduler_add (scheduler, GPK_SCHEDULER_PRIORITY_INTERACTIVE,
+				 "details", "a", gpk_test_scheduler_start,
+				 gpk_test_scheduler_cb, done);
+	g_assert (!ret);
+	g_assert_cmpint (gpk_scheduler_get_coalesced (scheduler), ==, 1);
+
+	/* something different of the same kind replaces it */
+	ret = gpk_scheduler_add (scheduler, GPK_SCHEDULER_PRIORITY_INTERACTIVE,
+				 "details", "b", gpk_test_scheduler_start,
+				 gpk_test_scheduler_cb, done);
+	g_assert (ret);
+	g_assert (!gpk_scheduler_contains (scheduler, "details", "a"));
+	g_assert (gpk_scheduler_contains (scheduler, "details", "b"));
+	while (done->len < 3)
+		g_main_context_iteration (NULL, TRUE);
+	g_assert_cmpstr (g_ptr_array_index (done, 0), ==, "a!");
+	g_assert_cmpstr (g_ptr_array_index (done, 1), ==, "b");
+	g_assert_cmpstr (g_ptr_array_index (done, 2), ==, "all");
+
+	/* interactive requests cancel any prefetch */
+	g_ptr_array_set_size (done, 0);
+	gpk_scheduler_add (scheduler, GPK_SCHEDULER_PRIORITY_PREFETCH,
+			   "prefetch", "x", gpk_test_scheduler_start,
+			   gpk_test_scheduler_cb, done);
+	gpk_scheduler_add (scheduler, GPK_SCHEDULER_PRIORITY_INTERACTIVE,
+			   "details", "c", gpk_test_scheduler_start,
+			   gpk_test_scheduler_cb, done);
+	while (done->len < 2)
+		g_main_context_iteration (NULL, TRUE);
+	g_assert_cmpstr (g_ptr_array_index (done, 0), ==, "x!");
+	g_assert_cmpstr (g_ptr_array_index (done, 1), ==, "c");
+}
+
+static void
+gpk_test_string_pool_func (void)
+{
+	const gchar *str1;
+	const gchar *str2;
+	g_autoptr(GpkStringPool) pool = NULL;
+
+	pool = gpk_string_pool_new ();
+	str1 = gpk_string_pool_intern (pool, "fedora");
+	g_assert_cmpstr (str1, ==, "fedora");
+	g_assert_cmpint (gpk_string_pool_get_size (pool), ==, 7);
+	g_assert_cmpint (gpk_string_pool_get_saved (pool), ==, 0);
+
+	/* the same string is the same handle */
+	str2 = gpk_string_pool_intern_len (pool, "fedora;updates", 6);
+	g_assert (str1 == str2);
+	g_assert_cmpint (gpk_string_pool_get_saved (pool), ==, 7);
+	str2 = gpk_string_pool_intern (pool, "updates");
+	g_assert (str1 != str2);
+	g_assert_cmpint (gpk_string_pool_get_length (pool), ==, 2);
+	g_assert_cmpint (gpk_string_pool_get_size (pool), ==, 15);
+	g_assert (gpk_string_pool_intern (pool, NULL) == NULL);
+}
+
+static void
+gpk_test_string_pool_memory_func (void)
+{
+	const gchar *repos[] = { "installed", "fedora", "updates" };
+	const guint rows = 50000;
+	GpkStringPool *pool = gpk_string_pool_get_default ();
+	gsize saved;
+	gsize size;
+	guint i;
+	g_autoptr(GpkPackageListModel) model = NULL;
+
+	/* what the model does not have to copy for each row */
+	saved = gpk_string_pool_get_saved (pool);
+	size = gpk_string_pool_get_size (pool);
+	model = gpk_package_list_model_new ();
+	for (i = 0; i < rows; i++) {
+		g_autofree gchar *package_id = NULL;
+		package_id = g_strdup_printf ("package%u;%u.%u.%u-%u.fc23;x86_64;%s",
+					      i, i % 7, i % 31, i % 101, i % 3 + 1,
+					      repos[i % 3]);
+		gpk_package_list_model_append (model, NULL, package_id, NULL,
+					       0, FALSE, TRUE, "pk-package-available");
+	}
+	saved = gpk_string_pool_get_saved (pool) - saved;
+	size = gpk_string_pool_get_size (pool) - size;
+	g_test_minimized_result (size,
+				 "%u rows: %" G_GSIZE_FORMAT " bytes interned, "
+				 "%" G_GSIZE_FORMAT " bytes saved",
+				 rows, size, saved);
+	g_assert_cmpint (saved, >, size);
+
+	/* versions are nearly unique, so they must not be in the pool */
+	g_assert_cmpint (size, <, 1024);
+}
+
+static void
+gpk_test_markup_formatter_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	GPtrArray **markup = (GPtrArray **) user_data;
+	g_autoptr(GError) error = NULL;
+
+	*markup = gpk_markup_formatter_format_finish (GPK_MARKUP_FORMATTER (source), res, &error);
+	g_assert_no_error (error);
+	g_assert (*markup != NULL);
+}
+
+static void
+gpk_test_markup_formatter_func (void)
+{
+	guint i;
+	g_autoptr(GpkMarkupFormatter) formatter = NULL;
+	g_autoptr(GPtrArray) packages = NULL;
+	GPtrArray *markup = NULL;
+
+	/* enough for several jobs */
+	formatter = gpk_markup_formatter_new ();
+	g_assert_cmpstr (gpk_markup_formatter_get_color (formatter), ==, "gray");
+	packages = g_ptr_array_new_with_free_func (g_object_unref);
+	for (i = 0; i < 1000; i++) {
+		g_autofree gchar *package_id = NULL;
+		package_id = g_strdup_printf ("pkg%04u;0.0.1;i386;fedora", i);
+		g_ptr_array_add (packages,
+				 gpk_test_package_new (package_id, PK_INFO_ENUM_AVAILABLE,
+						       i % 2 == 0 ? "Fish & chips" : NULL));
+	}
+	gpk_markup_formatter_format_async (formatter, packages, NULL,
+					   gpk_test_markup_formatter_cb, &markup);
+	while (markup == NULL)
+		g_main_context_iteration (NULL, TRUE);
+
+	/* the same as on the main thread, and in order */
+	g_assert_cmpint (markup->len, ==, packages->len);
+	for (i = 0; i < packages->len; i++) {
+		PkPackage *package = g_ptr_array_index (packages, i);
+		g_autofree gchar *text = NULL;
+		text = gpk_package_id_format_twoline (NULL,
+						      pk_package_get_id (package),
+						      pk_package_get_summary (package));
+		g_assert_cmpstr (g_ptr_array_index (markup, i), ==, text);
+	}
+	g_assert_cmpstr (g_ptr_array_index (markup, 0), ==,
+			 "Fish &amp; chips\n<span color=\"gray\">pkg0000-0.0.1 (32-bit)</span>");
+	g_ptr_array_unref (markup);
+}
+
+static PkDetails *
+gpk_test_details_new (const gchar *package_id)
+{
+	return g_object_new (PK_TYPE_DETAILS,
+			     "package-id", package_id,
+			     "description", "Lorem ipsum dolor sit amet",
+			     NULL);
+}
+
+static void
+gpk_test_details_cache_func (void)
+{
+	gsize size;
+	g_autoptr(GpkDetailsCache) cache = NULL;
+	g_autoptr(PkDetails) details1 = NULL;
+	g_autoptr(PkDetails) details2 = NULL;
+	g_autoptr(PkDetails) details3 = NULL;
+
+	details1 = gpk_test_details_new ("one;0.1;i386;fedora");
+	details2 = gpk_test_details_new ("two;0.1;i386;fedora");
+	details3 = gpk_test_details_new ("six;0.1;i386;fedora");
+
+	/* find out how big one entry is */
+	cache = gpk_details_cache_new (G_MAXSIZE);
+	gpk_details_cache_add (cache, details1);
+	size = gpk_details_cache_get_size (cache);
+	g_assert_cmpint (size, >, 0);
+	g_object_unref (cache);
+
+	/* room for two */
+	cache = gpk_details_cache_new (size * 2);
+	g_assert (gpk_details_cache_lookup (cache, "one;0.1;i386;fedora") == NULL);
+	gpk_details_cache_add (cache, details1);
+	gpk_details_cache_add (cache, details2);
+	g_assert (gpk_details_cache_lookup (cache, "one;0.1;i386;fedora") == details1);
+
+	/* the least recently used is dropped */
+	gpk_details_cache_add (cache, details3);
+	g_assert (gpk_details_cache_lookup (cache, "two;0.1;i386;fedora") == NULL);
+	g_assert (gpk_details_cache_lookup (cache, "one;0.1;i386;fedora") == details1);
+	g_assert (gpk_details_cache_lookup (cache, "six;0.1;i386;fedora") == details3);
+	g_assert_cmpint (gpk_details_cache_get_hits (cache), ==, 3);
+	g_assert_cmpint (gpk_details_cache_get_misses (cache), ==, 2);
+
+	/* adding again does not use more space */
+	gpk_details_cache_add (cache, details3);
+	g_assert_cmpint (gpk_details_cache_get_size (cache), ==, size * 2);
+
+	gpk_details_cache_invalidate (cache);
+	g_assert_cmpint (gpk_details_cache_get_size (cache), ==, 0);
+	g_assert (gpk_details_cache_lookup (cache, "one;0.1;i386;fedora") == NULL);
+}
+
+static void
+gpk_test_package_cache_search_func (void)
+{
+	const gchar *words[] = { "editor", "library", "game", "python", "fonts",
+				 "development", "files", "utility", "server", "client" };
+	const guint sizes[] = { 1000, 10000, 100000 };
+	const guint loops = 100;
+	gdouble elapsed_build;
+	gdouble elapsed_query;
+	guint i;
+	guint j;
+
+	for (j = 0; j < G_N_ELEMENTS (sizes); j++) {
+		g_autofree gchar *filename = NULL;
+		g_autoptr(GPtrArray) packages = NULL;
+		g_autoptr(GpkPackageCache) cache = NULL;
+		g_autoptr(GTimer) timer = g_timer_new ();
+		g_auto(GStrv) values_build = g_strsplit ("zzz", " ", -1);
+		g_auto(GStrv) values = g_strsplit ("pack 77", " ", -1);
+
+		packages = g_ptr_array_new_with_free_func (g_object_unref);
+		for (i = 0; i < sizes[j]; i++) {
+			g_autofree gchar *package_id = NULL;
+			g_autofree gchar *summary = NULL;
+			package_id = g_strdup_printf ("package%u;1.0-1.fc23;x86_64;fedora", i);
+			summary = g_strdup_printf ("A %s for %s number %u",
+						   words[i % G_N_ELEMENTS (words)],
+						   words[(i / 10) % G_N_ELEMENTS (words)], i);
+			g_ptr_array_add (packages, gpk_test_package_new (package_id,
+									 PK_INFO_ENUM_AVAILABLE,
+									 summary));
+		}
+		filename = g_build_filename (g_get_tmp_dir (), "gpk-self-test.cache", NULL);
+		cache = gpk_package_cache_new (filename);
+		gpk_package_cache_add_packages (cache, 0, NULL, packages);
+
+		/* the first search builds the index */
+		g_timer_reset (timer);
+		g_ptr_array_unref (gpk_package_cache_search_details (cache, 0, values_build));
+		elapsed_build = g_timer_elapsed (timer, NULL);
+
+		g_timer_reset (timer);
+		for (i = 0; i < loops; i++)
+			g_ptr_array_unref (gpk_package_cache_search_details (cache, 0, values));
+		elapsed_query = g_timer_elapsed (timer, NULL) / loops;
+
+		g_test_minimized_result (elapsed_query,
+					 "%u packages: index built in %.1fms, query took %.3fms",
+					 sizes[j], elapsed_build * 1000, elapsed_query * 1000);
+	}
+}
+
+static void
+gpk_test_package_id_parse_func (void)
+{
+	const gchar *package_id = "gnome-packagekit-common;3.22.0-1.fc25;x86_64;installed:fedora";
+	const guint loops = 1000000;
+	gdouble elapsed_split;
+	gdouble elapsed_view;
+	guint i;
+	guint total = 0;
+	GpkPackageIdView view;
+	g_autoptr(GTimer) timer = g_timer_new ();
+
+	/* what every row used to cost */
+	for (i = 0; i < loops; i++) {
+		g_auto(GStrv) split = pk_package_id_split (package_id);
+		total += strlen (split[PK_PACKAGE_ID_NAME]);
+	}
+	elapsed_split = g_timer_elapsed (timer, NULL) / loops;
+
+	g_timer_reset (timer);
+	for (i = 0; i < loops; i++) {
+		gpk_package_id_view_parse (&view, package_id);
+		total += view.len[PK_PACKAGE_ID_NAME];
+	}
+	elapsed_view = g_timer_elapsed (timer, NULL) / loops;
+	g_assert_cmpint (total, ==, loops * 2 * strlen ("gnome-packagekit-common"));
+
+	g_test_minimized_result (elapsed_view,
+				 "pk_package_id_split took %.1fns, gpk_package_id_view_parse took %.1fns",
+				 elapsed_split * 1e9, elapsed_view * 1e9);
+}
+
+static void
+gpk_test_enum_lookup_func (void)
+{
+	const guint loops = 1000000;
+	gdouble elapsed_switch;
+	gdouble elapsed_lookup;
+	guint i;
+	guint total = 0;
+	g_autoptr(GTimer) timer = g_timer_new ();
+
+	/* what each row and progress event used to cost */
+	for (i = 0; i < loops; i++)
+		total += gpk_status_enum_to_localised_text_real (PK_STATUS_ENUM_DOWNLOAD + i % 4) != NULL;
+	elapsed_switch = g_timer_elapsed (timer, NULL) / loops;
+
+	g_timer_reset (timer);
+	for (i = 0; i < loops; i++)
+		total += gpk_status_enum_to_localised_text (PK_STATUS_ENUM_DOWNLOAD + i % 4) != NULL;
+	elapsed_lookup = g_timer_elapsed (timer, NULL) / loops;
+	g_assert_cmpint (total, ==, loops * 2);
+
+	g_test_minimized_result (elapsed_lookup,
+				 "switch and gettext took %.1fns, table took %.1fns",
+				 elapsed_switch * 1e9, elapsed_lookup * 1e9);
+}
+
+static PkTransactionPast *
+gpk_test_transaction_new (guint i, gboolean succeeded)
+{
+	g_autofree gchar *data = NULL;
+	g_autofree gchar *timespec = NULL;
+
+	data = g_strdup_printf ("installing\tpackage%u;1.0-%u.fc23;x86_64;fedora\tA package\n"
+				"updating\tlibrary%u;2.%u-1.fc23;i686;updates\tA library",
+				i, i, i % 1000, i % 100);
+	timespec = g_strdup_printf ("2016-%02u-%02uT12:00:00Z", i % 12 + 1, i % 28 + 1);
+	return g_object_new (PK_TYPE_TRANSACTION_PAST,
+			     "role", i % 2 ? PK_ROLE_ENUM_UPDATE_PACKAGES : PK_ROLE_ENUM_INSTALL_PACKAGES,
+			     "timespec", timespec,
+			     "succeeded", succeeded,
+			     "cmdline", i % 3 ? "/usr/bin/gpk-application" : "/usr/bin/pkcon",
+			     "uid", 1000 + i % 4,
+			     "data", data,
+			     NULL);
+}
+
+static void
+gpk_test_log_index_func (void)
+{
+	guint i;
+	g_autoptr(GArray) matches = g_array_new (FALSE, FALSE, sizeof (guint));
+	g_autoptr(GpkLogIndex) log_index = gpk_log_index_new ();
+
+	for (i = 0; i < 6; i++) {
+		PkTransactionPast *item = gpk_test_transaction_new (i, i != 4);
+		gpk_log_index_add (log_index, item);
+		g_object_unref (item);
+	}
+	g_assert_cmpint (gpk_log_index_get_length (log_index), ==, 6);
+	g_assert_cmpint (gpk_log_index_get_role (log_index, 1), ==, PK_ROLE_ENUM_UPDATE_PACKAGES);
+	g_assert_cmpint (gpk_log_index_get_uid (log_index, 2), ==, 1002);
+	g_assert_cmpstr (gpk_log_index_get_cmdline (log_index, 3), ==, "/usr/bin/pkcon");
+	g_assert (gpk_log_index_get_succeeded (log_index, 3));
+	g_assert (!gpk_log_index_get_succeeded (log_index, 4));
+	g_assert_cmpint (gpk_log_index_get_timestamp (log_index, 0), ==, 1451649600);
+
+	/* everything that succeeded */
+	gpk_log_index_search (log_index, NULL, matches);
+	g_assert_cmpint (matches->len, ==, 5);
+
+	/* package name */
+	gpk_log_index_search (log_index, "package3", matches);
+	g_assert_cmpint (matches->len, ==, 1);
+	g_assert_cmpint (g_array_index (matches, guint, 0), ==, 3);
+
+	/* version and arch, but only once per transaction */
+	gpk_log_index_search (log_index, "2.5-", matches);
+	g_assert_cmpint (matches->len, ==, 1);
+	g_assert_cmpint (g_array_index (matches, guint, 0), ==, 5);
+	gpk_log_index_search (log_index, "i686", matches);
+	g_assert_cmpint (matches->len, ==, 5);
+
+	/* info type and command line */
+	gpk_log_index_search (log_index, "updating", matches);
+	g_assert_cmpint (matches->len, ==, 5);
+	gpk_log_index_search (log_index, "pkcon", matches);
+	g_assert_cmpint (matches->len, ==, 2);
+
+	/* the summary and repo are not searched, nor are failures */
+	gpk_log_index_search (log_index, "A package", matches);
+	g_assert_cmpint (matches->len, ==, 0);
+	gpk_log_index_search (log_index, "fedora", matches);
+	g_assert_cmpint (matches->len, ==, 0);
+	gpk_log_index_search (log_index, "package4", matches);
+	g_assert_cmpint (matches->len, ==, 0);
+
+	/* fields do not run into each other */
+	gpk_log_index_search (log_index, "package01.0", matches);
+	g_assert_cmpint (matches->len, ==, 0);
+}
+
+static void
+gpk_test_log_index_search_func (void)
+{
+	const gchar *filters[] = { "package99999", "library5", "pkcon", "zzz" };
+	const guint size = 100000;
+	gdouble elapsed_build;
+	gdouble elapsed_old;
+	gdouble elapsed_index;
+	guint i;
+	guint j;
+	guint total_old = 0;
+	g_autoptr(GArray) matches = g_array_new (FALSE, FALSE, sizeof (guint));
+	g_autoptr(GPtrArray) transactions = NULL;
+	g_autoptr(GpkLogIndex) log_index = gpk_log_index_new ();
+	g_autoptr(GTimer) timer = g_timer_new ();
+
+	transactions = g_ptr_array_new_with_free_func (g_object_unref);
+	for (i = 0; i < size; i++)
+		g_ptr_array_add (transactions, gpk_test_transaction_new (i, TRUE));
+
+	g_timer_reset (timer);
+	for (i = 0; i < size; i++)
+		gpk_log_index_add (log_index, g_ptr_array_index (transactions, i));
+	elapsed_build = g_timer_elapsed (timer, NULL);
+
+	/* what every keypress used to cost */
+	g_timer_reset (timer);
+	for (j = 0; j < G_N_ELEMENTS (filters); j++) {
+		for (i = 0; i < size; i++) {
+			guint k;
+			g_autofree gchar *cmdline = NULL;
+			g_autofree gchar *data = NULL;
+			g_auto(GStrv) lines = NULL;
+			g_object_get (g_ptr_array_index (transactions, i),
+				      "cmdline", &cmdline,
+				      "data", &data,
+				      NULL);
+			if (g_strrstr (cmdline, filters[j]) != NULL) {
+				total_old++;
+				continue;
+			}
+			lines = g_strsplit (data, "\n", 0);
+			for (k = 0; lines[k] != NULL; k++) {
+				GpkPackageIdView view;
+				g_auto(GStrv) sections = g_strsplit (lines[k], "\t", 0);
+				if (g_strrstr (sections[0], filters[j]) != NULL ||
+				    (gpk_package_id_view_parse (&view, sections[1]) &&
+				     (gpk_package_id_view_contains (&view, PK_PACKAGE_ID_NAME, filters[j]) ||
+				      gpk_package_id_view_contains (&view, PK_PACKAGE_ID_VERSION, filters[j]) ||
+				      gpk_package_id_view_contains (&view, PK_PACKAGE_ID_ARCH, filters[j])))) {
+					total_old++;
+					break;
+				}
+			}
+		}
+	}
+	elapsed_old = g_timer_elapsed (timer, NULL) / G_N_ELEMENTS (filters);
+
+	g_timer_reset (timer);
+	for (j = 0; j < G_N_ELEMENTS (filters); j++) {
+		gpk_log_index_search (log_index, filters[j], matches);
+		total_old -= matches->len;
+	}
+	elapsed_index = g_timer_elapsed (timer, NULL) / G_N_ELEMENTS (filters);
+	g_assert_cmpint (total_old, ==, 0);
+
+	g_test_minimized_result (elapsed_index,
+				 "%u transactions: index built in %.1fms, "
+				 "filter took %.2fms, was %.2fms",
+				 size, elapsed_build * 1000,
+				 elapsed_index * 1000, elapsed_old * 1000);
+}
+
+#ifdef HAVE_MALLINFO2
+static gsize
+gpk_test_get_heap_size (void)
+{
+	struct mallinfo2 info = mallinfo2 ();
+	return info.uordblks + info.hblkhd;
+}
+#endif
+
+static void
+gpk_test_package_list_model_memory_func (void)
+{
+#ifdef HAVE_MALLINFO2
+	const gchar *repos[] = { "installed", "fedora", "updates" };
+	const guint sizes[] = { 10000, 50000, 100000 };
+	GtkTreeIter iter;
+	gsize size_model;
+	gsize size_store;
+	gsize start;
+	guint i;
+	guint j;
+
+	for (j = 0; j < G_N_ELEMENTS (sizes); j++) {
+		g_autoptr(GtkListStore) store = NULL;
+		g_autoptr(GpkPackageListModel) model = NULL;
+
+		/* what gpk-application used to do */
+		start = gpk_test_get_heap_size ();
+		store = gtk_list_store_new (GPK_PACKAGE_LIST_COLUMN_LAST,
+					    G_TYPE_STRING, G_TYPE_UINT64,
+					    G_TYPE_BOOLEAN, G_TYPE_BOOLEAN,
+					    G_TYPE_STRING, G_TYPE_STRING,
+					    G_TYPE_STRING);
+		for (i = 0; i < sizes[j]; i++) {
+			g_autofree gchar *package_id = NULL;
+			g_autofree gchar *summary = NULL;
+			g_autofree gchar *text = NULL;
+			package_id = g_strdup_printf ("package%u;1.%u.0-1.fc23;x86_64;%s",
+						      i, i % 10, repos[i % 3]);
+			summary = g_strdup_printf ("The summary of package number %u", i);
+			text = gpk_package_id_format_twoline (NULL, package_id, summary);
+			gtk_list_store_append (store, &iter);
+			gtk_list_store_set (store, &iter,
+					    GPK_PACKAGE_LIST_COLUMN_STATE, (guint64) 0,
+					    GPK_PACKAGE_LIST_COLUMN_CHECKBOX, FALSE,
+					    GPK_PACKAGE_LIST_COLUMN_CHECKBOX_VISIBLE, TRUE,
+					    GPK_PACKAGE_LIST_COLUMN_TEXT, text,
+					    GPK_PACKAGE_LIST_COLUMN_SUMMARY, summary,
+					    GPK_PACKAGE_LIST_COLUMN_ID, package_id,
+					    GPK_PACKAGE_LIST_COLUMN_IMAGE, "pk-package-available",
+					    -1);
+		}
+		size_store = gpk_test_get_heap_size () - start;
+
+		/* the compact model */
+		start = gpk_test_get_heap_size ();
+		model = gpk_package_list_model_new ();
+		for (i = 0; i < sizes[j]; i++) {
+			g_autofree gchar *package_id = NULL;
+			g_autofree gchar *summary = NULL;
+			package_id = g_strdup_printf ("package%u;1.%u.0-1.fc23;x86_64;%s",
+						      i, i % 10, repos[i % 3]);
+			summary = g_strdup_printf ("The summary of package number %u", i);
+			gpk_package_list_model_append (model, NULL, package_id, summary,
+						       0, FALSE, TRUE, "pk-package-available");
+		}
+		size_model = gpk_test_get_heap_size () - start;
+
+		g_test_minimized_result (size_model / 1024,
+					 "%u rows: GtkListStore %" G_GSIZE_FORMAT "KiB, "
+					 "GpkPackageListModel %" G_GSIZE_FORMAT "KiB",
+					 sizes[j], size_store / 1024, size_model / 1024);
+		g_assert_cmpint (size_model, <, size_store);
+	}
+#else
+	g_test_skip ("mallinfo2() is not available");
+#endif
 }
 
 static void
@@ -349,8 +1312,31 @@ main (int argc, char **argv)
 	g_test_init (&argc, &argv, NULL);
 
 	g_test_add_func ("/gnome-packagekit/enum", gpk_test_enum_func);
+	g_test_add_func ("/gnome-packagekit/enum-icons", gpk_test_enum_icons_func);
 	g_test_add_func ("/gnome-packagekit/common", gpk_test_common_func);
+	g_test_add_func ("/gnome-packagekit/category-tree", gpk_test_category_tree_func);
 	g_test_add_func ("/gnome-packagekit/markdown", gpk_test_markdown_func);
+	g_test_add_func ("/gnome-packagekit/package-list-model", gpk_test_package_list_model_func);
+	g_test_add_func ("/gnome-packagekit/package-cache", gpk_test_package_cache_func);
+	g_test_add_func ("/gnome-packagekit/details-cache", gpk_test_details_cache_func);
+	g_test_add_func ("/gnome-packagekit/scheduler", gpk_test_scheduler_func);
+	g_test_add_func ("/gnome-packagekit/markup-formatter", gpk_test_markup_formatter_func);
+	g_test_add_func ("/gnome-packagekit/string-pool", gpk_test_string_pool_func);
+	g_test_add_func ("/gnome-packagekit/log-index", gpk_test_log_index_func);
+	if (g_test_perf ()) {
+		g_test_add_func ("/gnome-packagekit/package-list-model-memory",
+				 gpk_test_package_list_model_memory_func);
+		g_test_add_func ("/gnome-packagekit/package-cache-search",
+				 gpk_test_package_cache_search_func);
+		g_test_add_func ("/gnome-packagekit/package-id-parse",
+				 gpk_test_package_id_parse_func);
+		g_test_add_func ("/gnome-packagekit/string-pool-memory",
+				 gpk_test_string_pool_memory_func);
+		g_test_add_func ("/gnome-packagekit/enum-lookup",
+				 gpk_test_enum_lookup_func);
+		g_test_add_func ("/gnome-packagekit/log-index-search",
+				 gpk_test_log_index_search_func);
+	}
 	if (g_test_thorough ()) {
 		g_test_add_func ("/gnome-packagekit/error", gpk_test_error_func);
 		g_test_add_func ("/gnome-packagekit/task", gpk_test_task_func);
@@ -0,0 +1,201 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib.h>
+
+#include "gpk-string-pool.h"
+
+/*
+ * The pool only ever grows, so it should only be used for fields that
+ * have a few distinct values, e.g. the repo or arch of a package, and
+ * not the version which is different for nearly every package. The
+ * strings are never freed so can be used as handles that compare equal
+ * by pointer.
+ */
+struct _GpkStringPool
+{
+	GObject			 parent_instance;
+	GMutex			 mutex;
+	GHashTable		*hash;		/* of interned string */
+	GStringChunk		*chunk;
+	gsize			 size;
+	gsize			 saved;
+};
+
+G_DEFINE_TYPE (GpkStringPool, gpk_string_pool, G_TYPE_OBJECT)
+
+/**
+ * gpk_string_pool_intern_len:
+ * @str: a string, which does not have to be NUL terminated
+ * @len: the length of @str
+ *
+ * Return value: a copy of @str that lives as long as @pool
+ **/
+const gchar *
+gpk_string_pool_intern_len (GpkStringPool *pool, const gchar *str, gsize len)
+{
+	gchar buf[256];
+	g_autofree gchar *tmp = NULL;
+	const gchar *key;
+	gchar *interned;
+
+	g_return_val_if_fail (GPK_IS_STRING_POOL (pool), NULL);
+
+	if (str == NULL)
+		return NULL;
+
+	/* the hash table needs a NUL terminated key */
+	if (len < sizeof (buf)) {
+		memcpy (buf, str, len);
+		buf[len] = '\0';
+		key = buf;
+	} else {
+		tmp = g_strndup (str, len);
+		key = tmp;
+	}
+
+	g_mutex_lock (&pool->mutex);
+	interned = g_hash_table_lookup (pool->hash, key);
+	if (interned != NULL) {
+		pool->saved += len + 1;
+	} else {
+		interned = g_string_chunk_insert_len (pool->chunk, key, len);
+		g_hash_table_add (pool->hash, interned);
+		pool->size += len + 1;
+	}
+	g_mutex_unlock (&pool->mutex);
+	return interned;
+}
+
+/**
+ * gpk_string_pool_intern:
+ **/
+const gchar *
+gpk_string_pool_intern (GpkStringPool *pool, const gchar *str)
+{
+	if (str == NULL)
+		return NULL;
+	return gpk_string_pool_intern_len (pool, str, strlen (str));
+}
+
+/**
+ * gpk_string_pool_get_length:
+ *
+ * Return value: the number of distinct strings
+ **/
+guint
+gpk_string_pool_get_length (GpkStringPool *pool)
+{
+	guint len;
+	g_return_val_if_fail (GPK_IS_STRING_POOL (pool), 0);
+	g_mutex_lock (&pool->mutex);
+	len = g_hash_table_size (pool->hash);
+	g_mutex_unlock (&pool->mutex);
+	return len;
+}
+
+/**
+ * gpk_string_pool_get_size:
+ *
+ * Return value: the number of bytes used by the distinct strings
+ **/
+gsize
+gpk_string_pool_get_size (GpkStringPool *pool)
+{
+	gsize size;
+	g_return_val_if_fail (GPK_IS_STRING_POOL (pool), 0);
+	g_mutex_lock (&pool->mutex);
+	size = pool->size;
+	g_mutex_unlock (&pool->mutex);
+	return size;
+}
+
+/**
+ * gpk_string_pool_get_saved:
+ *
+ * Return value: the number of bytes that copying each string would have used
+ **/
+gsize
+gpk_string_pool_get_saved (GpkStringPool *pool)
+{
+	gsize saved;
+	g_return_val_if_fail (GPK_IS_STRING_POOL (pool), 0);
+	g_mutex_lock (&pool->mutex);
+	saved = pool->saved;
+	g_mutex_unlock (&pool->mutex);
+	return saved;
+}
+
+static void
+gpk_string_pool_finalize (GObject *object)
+{
+	GpkStringPool *pool = GPK_STRING_POOL (object);
+
+	g_hash_table_unref (pool->hash);
+	g_string_chunk_free (pool->chunk);
+	g_mutex_clear (&pool->mutex);
+
+	G_OBJECT_CLASS (gpk_string_pool_parent_class)->finalize (object);
+}
+
+static void
+gpk_string_pool_class_init (GpkStringPoolClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	object_class->finalize = gpk_string_pool_finalize;
+}
+
+static void
+gpk_string_pool_init (GpkStringPool *pool)
+{
+	g_mutex_init (&pool->mutex);
+	pool->hash = g_hash_table_new (g_str_hash, g_str_equal);
+	pool->chunk = g_string_chunk_new (1024);
+}
+
+/**
+ * gpk_string_pool_new:
+ **/
+GpkStringPool *
+gpk_string_pool_new (void)
+{
+	return g_object_new (GPK_TYPE_STRING_POOL, NULL);
+}
+
+/**
+ * gpk_string_pool_get_default:
+ *
+ * Return value: (transfer none): the pool shared by the whole process
+ **/
+GpkStringPool *
+gpk_string_pool_get_default (void)
+{
+	static GpkStringPool *pool = NULL;
+
+	if (g_once_init_enter (&pool)) {
+		GpkStringPool *tmp = gpk_string_pool_new ();
+		g_once_init_leave (&pool, tmp);
+	}
+	return pool;
+}
@@ -0,0 +1,46 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef GPK_STRING_POOL_H
+#define GPK_STRING_POOL_H
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define GPK_TYPE_STRING_POOL (gpk_string_pool_get_type())
+G_DECLARE_FINAL_TYPE (GpkStringPool, gpk_string_pool, GPK, STRING_POOL, GObject)
+
+GType		 gpk_string_pool_get_type	(void);
+GpkStringPool	*gpk_string_pool_new		(void);
+GpkStringPool	*gpk_string_pool_get_default	(void);
+const gchar	*gpk_string_pool_intern		(GpkStringPool	*pool,
+						 const gchar	*str);
+const gchar	*gpk_string_pool_intern_len	(GpkStringPool	*pool,
+						 const gchar	*str,
+						 gsize		 len);
+guint		 gpk_string_pool_get_length	(GpkStringPool	*pool);
+gsize		 gpk_string_pool_get_size	(GpkStringPool	*pool);
+gsize		 gpk_string_pool_get_saved	(GpkStringPool	*pool);
+
+G_END_DECLS
+
+#endif /* GPK_STRING_POOL_H */
@@ -40,12 +40,17 @@
 #include "gpk-dialog.h"
 #include "gpk-enum.h"
 #include "gpk-error.h"
+#include "gpk-markup-formatter.h"
 #include "gpk-task.h"
 #include "gpk-debug.h"
 
 #define GPK_UPDATE_VIEWER_AUTO_QUIT_TIMEOUT	10 /* seconds */
 #define GPK_UPDATE_VIEWER_AUTO_RESTART_TIMEOUT	60 /* seconds */
 #define GPK_UPDATE_VIEWER_MOBILE_SMALL_SIZE	512*1024 /* bytes */
+#define GPK_UPDATE_VIEWER_DETAILS_CHUNK		50 /* packages */
+#define GPK_UPDATE_VIEWER_DESCRIPTION_CACHE	32 /* descriptions */
+#define GPK_UPDATE_VIEWER_CHANGELOG_INLINE	4096 /* bytes */
+#define GPK_UPDATE_VIEWER_CHANGELOG_CHUNK	16384 /* bytes */
 
 static	gboolean		 ignore_updates_changed = FALSE;
 static	gchar			*package_id_last = NULL;
@@ -53,6 +58,10 @@ static	guint			 auto_shutdown_id = 0;
 static	guint			 size_total = 0;
 static	guint			 number_total = 0;
 static	PkRestartEnum		 restart_worst = 0;
+static	guint			 rows_total = 0;
+static	guint			 rows_selected = 0;
+static	guint			 restart_selected[PK_RESTART_ENUM_LAST];
+static	GHashTable		*row_states = NULL;
 #ifdef HAVE_SYSTEMD
 static  SystemdProxy		*proxy = NULL;
 #endif
@@ -61,7 +70,9 @@ static	GSettings		*settings = NULL;
 static	GPtrArray		*update_array = NULL;
 static	GtkBuilder		*builder = NULL;
 static	GtkTreeStore		*array_store_updates = NULL;
+static	GHashTable		*array_store_rows = NULL;
 static	GtkTextBuffer		*text_buffer = NULL;
+static	GpkMarkupFormatter	*formatter = NULL;
 static	PkControl		*control = NULL;
 static	PkRestartEnum		 restart_update = 0;
 static	PkTask			*task = NULL;
@@ -92,6 +103,9 @@ enum {
 };
 
 static gboolean gpk_update_viewer_get_new_update_array (void);
+static void gpk_update_viewer_progress_discard (void);
+static void gpk_update_viewer_details_queue_clear (void);
+static void gpk_update_viewer_details_chunk_done (void);
 
 static gboolean
 _g_strzero (const gchar *text)
@@ -311,37 +325,9 @@ gpk_update_viewer_check_blocked_packages (GPtrArray *array)
 }
 
 static gboolean
-gpk_update_viewer_are_all_updates_selected (GtkTreeModel *model)
+gpk_update_viewer_are_all_updates_selected (void)
 {
-	gboolean selected = TRUE;
-	gboolean valid;
-	gboolean child_valid;
-	GtkTreeIter child_iter;
-	GtkTreeIter iter;
-
-	/* if there are no entries selected, deselect the button */
-	valid = gtk_tree_model_get_iter_first (model, &iter);
-	while (valid) {
-		gtk_tree_model_get (model, &iter,
-				    GPK_UPDATES_COLUMN_SELECT, &selected,
-				    -1);
-		if (!selected)
-			return FALSE;
-
-		/* do for children too */
-		child_valid = gtk_tree_model_iter_children (model, &child_iter, &iter);
-		while (child_valid) {
-			gtk_tree_model_get (model, &child_iter,
-					    GPK_UPDATES_COLUMN_SELECT, &selected,
-					    -1);
-			if (!selected)
-				return FALSE;
-			child_valid = gtk_tree_model_iter_next (model, &child_iter);
-		}
-
-		valid = gtk_tree_model_iter_next (model, &iter);
-	}
-	return TRUE;
+	return rows_selected == rows_total;
 }
 
 static void
@@ -448,7 +434,7 @@ gpk_update_viewer_update_packages_cb (PkTask *_task, GAsyncResult *res, gpointer
 	/* do different text depending on if we deselected any */
 	treeview = GTK_TREE_VIEW(gtk_builder_get_object (builder, "treeview_updates"));
 	model = gtk_tree_view_get_model (treeview);
-	ret = gpk_update_viewer_are_all_updates_selected (model);
+	ret = gpk_update_viewer_are_all_updates_selected ();
 	if (ret) {
 		/* TRANSLATORS: title: all updates for the machine installed okay */
 		message = _("All updates were installed successfully.");
@@ -489,144 +475,232 @@ out:
 	ignore_updates_changed = FALSE;
 }
 
-static GSList *active_rows = NULL;
-static guint active_row_timeout_id = 0;
-
-static gint
-gpk_update_viewer_compare_refs (GtkTreeRowReference *a, GtkTreeRowReference *b)
+static void
+gpk_update_viewer_model_add_row (GtkTreeModel *model, GtkTreeIter *iter, const gchar *package_id)
 {
-	GtkTreeModel *am, *bm;
-	GtkTreePath *ap, *bp;
-	gint res;
-
-	am = gtk_tree_row_reference_get_model (a);
-	bm = gtk_tree_row_reference_get_model (b);
-
-	res = 1;
-	if (am == bm) {
-		ap = gtk_tree_row_reference_get_path (a);
-		bp = gtk_tree_row_reference_get_path (b);
-
-		res = gtk_tree_path_compare (ap, bp);
+	GtkTreePath *path;
 
-		gtk_tree_path_free (ap);
-		gtk_tree_path_free (bp);
-	}
+	/* the reference follows the row when the store is sorted */
+	path = gtk_tree_model_get_path (model, iter);
+	g_hash_table_insert (array_store_rows,
+			     g_strdup (package_id),
+			     gtk_tree_row_reference_new (model, path));
+	gtk_tree_path_free (path);
+}
 
-	return res;
+static GtkTreePath *
+gpk_update_viewer_model_get_path (GtkTreeModel *model, const gchar *package_id)
+{
+	GtkTreeRowReference *ref;
+	g_return_val_if_fail (package_id != NULL, NULL);
+	ref = g_hash_table_lookup (array_store_rows, package_id);
+	if (ref == NULL)
+		return NULL;
+	return gtk_tree_row_reference_get_path (ref);
 }
 
+static GHashTable *active_rows = NULL;
+static guint active_row_timeout_id = 0;
+
 static gboolean
 gpk_update_viewer_pulse_active_rows (void)
 {
-	GSList *l;
-	GtkTreeRowReference *ref;
-	GtkTreeModel *model;
-	GtkTreePath *path;
 	GtkTreeIter iter;
+	GtkTreeModel *model;
+	GtkTreePath *end = NULL;
+	GtkTreePath *path = NULL;
+	GtkTreeView *treeview;
 	gint val;
 
-	for (l = active_rows; l; l = l->next) {
-		ref = l->data;
-		model = gtk_tree_row_reference_get_model (ref);
-		path = gtk_tree_row_reference_get_path (ref);
-		if (path) {
-			gtk_tree_model_get_iter (model, &iter, path);
-			gtk_tree_model_get (model, &iter, GPK_UPDATES_COLUMN_PULSE, &val, -1);
+	/* nothing is on screen */
+	treeview = GTK_TREE_VIEW(gtk_builder_get_object (builder, "treeview_updates"));
+	if (!gtk_tree_view_get_visible_range (treeview, &path, &end))
+		return TRUE;
+
+	/* only redraw the spinners that can be seen, walking the visible
+	 * rows with the one path so off-screen rows cost nothing; rows that
+	 * are not active have a pulse of -1 */
+	model = gtk_tree_view_get_model (treeview);
+	while (gtk_tree_path_compare (path, end) <= 0 &&
+	       gtk_tree_model_get_iter (model, &iter, path)) {
+		gtk_tree_model_get (model, &iter, GPK_UPDATES_COLUMN_PULSE, &val, -1);
+		if (val >= 0)
 			gtk_tree_store_set (GTK_TREE_STORE(model), &iter, GPK_UPDATES_COLUMN_PULSE, val + 1, -1);
-			gtk_tree_path_free (path);
+
+		/* next row in the order shown */
+		if (gtk_tree_model_iter_has_child (model, &iter) &&
+		    gtk_tree_view_row_expanded (treeview, path)) {
+			gtk_tree_path_down (path);
+			continue;
+		}
+		gtk_tree_path_next (path);
+		while (!gtk_tree_model_get_iter (model, &iter, path) &&
+		       gtk_tree_path_get_depth (path) > 1) {
+			gtk_tree_path_up (path);
+			gtk_tree_path_next (path);
 		}
 	}
-
+	gtk_tree_path_free (path);
+	gtk_tree_path_free (end);
 	return TRUE;
 }
 
 static void
-gpk_update_viewer_add_active_row (GtkTreeModel *model, GtkTreePath *path)
+gpk_update_viewer_add_active_row (GtkTreeModel *model, const gchar *package_id)
 {
-	GtkTreeRowReference *ref;
-	GSList *row = NULL;
+	GtkTreeIter iter;
+	GtkTreePath *path;
 
 	/* check if already active */
-	ref = gtk_tree_row_reference_new (model, path);
-	if (ref == NULL)
-		return;
-	row = g_slist_find_custom (active_rows, (gconstpointer)ref, (GCompareFunc)gpk_update_viewer_compare_refs);
-	if (row != NULL) {
+	if (g_hash_table_contains (active_rows, package_id)) {
 		g_debug ("already active");
-		gtk_tree_row_reference_free (ref);
 		return;
 	}
 
+	/* a pulse of zero or more is what makes the timeout animate it */
+	path = gpk_update_viewer_model_get_path (model, package_id);
+	if (path != NULL) {
+		gtk_tree_model_get_iter (model, &iter, path);
+		gtk_tree_store_set (GTK_TREE_STORE(model), &iter, GPK_UPDATES_COLUMN_PULSE, 0, -1);
+		gtk_tree_path_free (path);
+	}
+
 	/* add poll */
 	if (active_row_timeout_id == 0) {
 		active_row_timeout_id = g_timeout_add (60, (GSourceFunc)gpk_update_viewer_pulse_active_rows, NULL);
 		g_source_set_name_by_id (active_row_timeout_id, "[GpkUpdateViewer] pulse row");
 	}
-	active_rows = g_slist_prepend (active_rows, ref);
+	g_hash_table_add (active_rows, g_strdup (package_id));
 }
 
 static void
-gpk_update_viewer_remove_active_row (GtkTreeModel *model, GtkTreePath *path)
+gpk_update_viewer_remove_active_row (GtkTreeModel *model, const gchar *package_id)
 {
-	GSList *row;
-	GtkTreeRowReference *ref;
 	GtkTreeIter iter;
+	GtkTreePath *path;
 
-	gtk_tree_model_get_iter (model, &iter, path);
-	gtk_tree_store_set (GTK_TREE_STORE(model), &iter, GPK_UPDATES_COLUMN_PULSE, -1, -1);
+	path = gpk_update_viewer_model_get_path (model, package_id);
+	if (path != NULL) {
+		gtk_tree_model_get_iter (model, &iter, path);
+		gtk_tree_store_set (GTK_TREE_STORE(model), &iter, GPK_UPDATES_COLUMN_PULSE, -1, -1);
+		gtk_tree_path_free (path);
+	}
 
-	ref = gtk_tree_row_reference_new (model, path);
-	row = g_slist_find_custom (active_rows, (gconstpointer)ref, (GCompareFunc)gpk_update_viewer_compare_refs);
-	gtk_tree_row_reference_free (ref);
-	if (row == NULL) {
-		g_warning ("row not already added");
+	if (!g_hash_table_remove (active_rows, package_id)) {
+		/* progress is coalesced, so it may have finished in one frame */
+		g_debug ("row not already added");
 		return;
 	}
 
-	active_rows = g_slist_remove_link (active_rows, row);
-	gtk_tree_row_reference_free (row->data);
-	g_slist_free (row);
-
-	if (active_rows == NULL) {
+	if (g_hash_table_size (active_rows) == 0) {
 		g_source_remove (active_row_timeout_id);
 		active_row_timeout_id = 0;
 	}
 }
 
-static gboolean
-gpk_update_viewer_find_iter_model_cb (GtkTreeModel *model,
-				      GtkTreePath *path,
-				      GtkTreeIter *iter,
-				      const gchar *package_id)
+typedef struct {
+	gboolean		 selected;
+	gboolean		 is_update;
+	guint			 size;
+	PkRestartEnum		 restart;
+} GpkUpdateViewerRowState;
+
+/* keep the totals for the selected updates in step with the model */
+static void
+gpk_update_viewer_row_state_count (GpkUpdateViewerRowState *state, gboolean add)
 {
-	g_autofree gchar *package_id_tmp = NULL;
-	GtkTreePath **_path = NULL;
+	if (!state->selected)
+		return;
+	if (add)
+		rows_selected++;
+	else
+		rows_selected--;
+	if (!state->is_update)
+		return;
+	if (add) {
+		number_total++;
+		size_total += state->size;
+		restart_selected[state->restart]++;
+	} else {
+		number_total--;
+		size_total -= state->size;
+		restart_selected[state->restart]--;
+	}
+}
+
+static void
+gpk_update_viewer_row_changed_cb (GtkTreeModel *model, GtkTreePath *path,
+				  GtkTreeIter *iter, gpointer user_data)
+{
+	GpkUpdateViewerRowState *state;
+	PkRestartEnum restart;
+	gboolean selected;
+	guint size;
 
+	/* tree store iters persist, so the node identifies the row */
+	state = g_hash_table_lookup (row_states, iter->user_data);
+	if (state == NULL) {
+		state = g_new0 (GpkUpdateViewerRowState, 1);
+		g_hash_table_insert (row_states, iter->user_data, state);
+		rows_total++;
+	}
 	gtk_tree_model_get (model, iter,
-			    GPK_UPDATES_COLUMN_ID, &package_id_tmp,
+			    GPK_UPDATES_COLUMN_SELECT, &selected,
+			    GPK_UPDATES_COLUMN_SIZE, &size,
+			    GPK_UPDATES_COLUMN_RESTART, &restart,
 			    -1);
-	if (package_id_tmp == NULL)
-		return FALSE;
 
-	/* match on the package id */
-	if (g_strcmp0 (package_id, package_id_tmp) == 0) {
-		_path = (GtkTreePath **) g_object_get_data (G_OBJECT(model), "_path");
-		*_path = gtk_tree_path_copy (path);
-		return TRUE;
+	/* the headers never get a package ID */
+	if (!state->is_update) {
+		g_autofree gchar *package_id = NULL;
+		gtk_tree_model_get (model, iter,
+				    GPK_UPDATES_COLUMN_ID, &package_id,
+				    -1);
+		state->is_update = package_id != NULL;
 	}
-	return FALSE;
+
+	gpk_update_viewer_row_state_count (state, FALSE);
+	state->selected = selected;
+	state->size = size;
+	state->restart = MIN (restart, PK_RESTART_ENUM_LAST - 1);
+	gpk_update_viewer_row_state_count (state, TRUE);
 }
 
-static GtkTreePath *
-gpk_update_viewer_model_get_path (GtkTreeModel *model, const gchar *package_id)
+static void
+gpk_update_viewer_row_states_clear (void)
 {
-	GtkTreePath *path = NULL;
-	g_return_val_if_fail (package_id != NULL, NULL);
-	g_object_set_data (G_OBJECT(model), "_path", (gpointer) &path);
-	gtk_tree_model_foreach (model, (GtkTreeModelForeachFunc) gpk_update_viewer_find_iter_model_cb, (gpointer) package_id);
-	g_object_steal_data (G_OBJECT(model), "_path");
-	return path;
+	guint i;
+
+	g_hash_table_remove_all (row_states);
+	rows_total = 0;
+	rows_selected = 0;
+	number_total = 0;
+	size_total = 0;
+	for (i = 0; i < PK_RESTART_ENUM_LAST; i++)
+		restart_selected[i] = 0;
+}
+
+static void
+gpk_update_viewer_model_clear (void)
+{
+	/* the rows these were for are about to go */
+	if (progress_pending != NULL)
+		gpk_update_viewer_progress_discard ();
+
+	/* any details still to come are for the old rows */
+	gpk_update_viewer_details_queue_clear ();
+
+	/* stop any spinners */
+	g_hash_table_remove_all (active_rows);
+	if (active_row_timeout_id != 0) {
+		g_source_remove (active_row_timeout_id);
+		active_row_timeout_id = 0;
+	}
+
+	/* drop the references first so they are not updated for each removed row */
+	g_hash_table_remove_all (array_store_rows);
+	gtk_tree_store_clear (array_store_updates);
+	gpk_update_viewer_row_states_clear ();
 }
 
 static const gchar *
@@ -735,6 +809,230 @@ gpk_update_viewer_get_parent_for_info (PkInfoEnum info, GtkTreeIter *parent)
 	}
 }
 
+typedef struct {
+	gchar			*package_id;
+	gchar			*summary;
+	gboolean		 has_package;
+	PkRoleEnum		 role;
+	PkInfoEnum		 info;
+	PkInfoEnum		 info_active;	/* the last info that was not finished */
+	gint			 percentage;	/* -1 for no item progress */
+} GpkUpdateViewerProgressItem;
+
+static GHashTable *progress_pending = NULL;
+static GPtrArray *progress_pending_order = NULL;
+static guint progress_tick_id = 0;
+static guint progress_events_received = 0;
+static guint progress_events_applied = 0;
+
+static void
+gpk_update_viewer_progress_item_free (GpkUpdateViewerProgressItem *item)
+{
+	g_free (item->package_id);
+	g_free (item->summary);
+	g_free (item);
+}
+
+static GpkUpdateViewerProgressItem *
+gpk_update_viewer_progress_item_get (const gchar *package_id)
+{
+	GpkUpdateViewerProgressItem *item;
+
+	item = g_hash_table_lookup (progress_pending, package_id);
+	if (item != NULL)
+		return item;
+
+	/* first event for this package since the last frame */
+	item = g_new0 (GpkUpdateViewerProgressItem, 1);
+	item->package_id = g_strdup (package_id);
+	item->info = PK_INFO_ENUM_UNKNOWN;
+	item->info_active = PK_INFO_ENUM_UNKNOWN;
+	item->percentage = -1;
+	g_hash_table_insert (progress_pending, item->package_id, item);
+	g_ptr_array_add (progress_pending_order, item);
+	return item;
+}
+
+static void
+gpk_update_viewer_progress_apply_package (GtkTreeView *treeview,
+					  GtkTreeModel *model,
+					  GpkUpdateViewerProgressItem *item,
+					  gboolean scroll)
+{
+	GtkTreeIter iter;
+	GtkTreePath *path;
+	GtkTreeViewColumn *column;
+	PkInfoEnum info = item->info;
+
+	/* enable or disable the correct spinners */
+	if (item->role == PK_ROLE_ENUM_UPDATE_PACKAGES) {
+		if (info == PK_INFO_ENUM_FINISHED)
+			gpk_update_viewer_remove_active_row (model, item->package_id);
+		else
+			gpk_update_viewer_add_active_row (model, item->package_id);
+	}
+
+	/* update icon */
+	path = gpk_update_viewer_model_get_path (model, item->package_id);
+	if (path == NULL) {
+		g_autofree gchar *text = NULL;
+		text = gpk_markup_formatter_format (formatter,
+						    item->package_id,
+						    item->summary);
+		g_debug ("adding: id=%s, text=%s", item->package_id, text);
+
+		/* add to model */
+		gtk_tree_store_append (array_store_updates, &iter, NULL);
+		gtk_tree_store_set (array_store_updates, &iter,
+				    GPK_UPDATES_COLUMN_TEXT, text,
+				    GPK_UPDATES_COLUMN_ID, item->package_id,
+				    GPK_UPDATES_COLUMN_INFO, info,
+				    GPK_UPDATES_COLUMN_SELECT, TRUE,
+				    GPK_UPDATES_COLUMN_VISIBLE, TRUE,
+				    GPK_UPDATES_COLUMN_SENSITIVE, FALSE,
+				    GPK_UPDATES_COLUMN_CLICKABLE, FALSE,
+				    GPK_UPDATES_COLUMN_RESTART, PK_RESTART_ENUM_NONE,
+				    GPK_UPDATES_COLUMN_STATUS, PK_INFO_ENUM_UNKNOWN,
+				    GPK_UPDATES_COLUMN_SIZE, 0,
+				    GPK_UPDATES_COLUMN_SIZE_DISPLAY, 0,
+				    GPK_UPDATES_COLUMN_PERCENTAGE, 0,
+				    GPK_UPDATES_COLUMN_PULSE,
+				    g_hash_table_contains (active_rows, item->package_id) ? 0 : -1,
+				    -1);
+		gpk_update_viewer_model_add_row (model, &iter, item->package_id);
+		path = gtk_tree_model_get_path (model, &iter);
+	} else {
+		gtk_tree_model_get_iter (model, &iter, path);
+	}
+
+	/* if we are adding deps, then select the checkbox */
+	if (item->role == PK_ROLE_ENUM_UPDATE_PACKAGES) {
+		gtk_tree_store_set (array_store_updates, &iter,
+				    GPK_UPDATES_COLUMN_SELECT, TRUE,
+				    -1);
+	}
+
+	/* scroll to the active cell */
+	if (scroll) {
+		column = gtk_tree_view_get_column (treeview, 3);
+		gtk_tree_view_scroll_to_cell (treeview, path, column, FALSE, 0.0f, 0.0f);
+	}
+
+	/* only change the status when we're doing the actual update */
+	if (item->role == PK_ROLE_ENUM_UPDATE_PACKAGES) {
+		/* if the info is finished, change the status to past tense */
+		if (info == PK_INFO_ENUM_FINISHED) {
+			/* clear the remaining size */
+			gtk_tree_store_set (array_store_updates, &iter,
+					    GPK_UPDATES_COLUMN_SIZE_DISPLAY, 0, -1);
+
+			/* the package may have started and finished in one frame */
+			if (item->info_active != PK_INFO_ENUM_UNKNOWN) {
+				info = item->info_active;
+			} else {
+				gtk_tree_model_get (model, &iter,
+						    GPK_UPDATES_COLUMN_STATUS, &info, -1);
+			}
+			/* promote to past tense if present tense */
+			if (info < PK_INFO_ENUM_LAST)
+				info += PK_INFO_ENUM_LAST;
+		}
+		gtk_tree_store_set (array_store_updates, &iter,
+				    GPK_UPDATES_COLUMN_STATUS, info, -1);
+	}
+
+	gtk_tree_path_free (path);
+}
+
+static void
+gpk_update_viewer_progress_apply_percentage (GtkTreeModel *model,
+					     GpkUpdateViewerProgressItem *item)
+{
+	GtkTreeIter iter;
+	GtkTreePath *path;
+	guint size;
+	guint size_display;
+
+	path = gpk_update_viewer_model_get_path (model, item->package_id);
+	if (path == NULL) {
+		g_debug ("not found ID for %s", item->package_id);
+		return;
+	}
+
+	gtk_tree_model_get_iter (model, &iter, path);
+	gtk_tree_model_get (model, &iter,
+			    GPK_UPDATES_COLUMN_SIZE, &size,
+			    -1);
+	size_display = size - ((size * item->percentage) / 100);
+	gtk_tree_store_set (array_store_updates, &iter,
+			    GPK_UPDATES_COLUMN_PERCENTAGE, item->percentage,
+			    GPK_UPDATES_COLUMN_SIZE_DISPLAY, size_display,
+			    -1);
+	gtk_tree_path_free (path);
+}
+
+static void
+gpk_update_viewer_progress_discard (void)
+{
+	g_ptr_array_set_size (progress_pending_order, 0);
+	g_hash_table_remove_all (progress_pending);
+}
+
+static void
+gpk_update_viewer_progress_flush (void)
+{
+	gboolean scroll;
+	GpkUpdateViewerProgressItem *item;
+	GtkTreeModel *model;
+	GtkTreeView *treeview;
+	guint i;
+
+	if (progress_pending_order->len == 0)
+		return;
+
+	treeview = GTK_TREE_VIEW(gtk_builder_get_object (builder, "treeview_updates"));
+	model = gtk_tree_view_get_model (treeview);
+
+	/* only scroll to the package we heard about last */
+	scroll = g_settings_get_boolean (settings, GPK_SETTINGS_SCROLL_ACTIVE);
+	for (i = 0; i < progress_pending_order->len; i++) {
+		item = g_ptr_array_index (progress_pending_order, i);
+		if (item->has_package) {
+			gpk_update_viewer_progress_apply_package (treeview, model, item,
+								  scroll && g_strcmp0 (item->package_id,
+										       package_id_last) == 0);
+		}
+		if (item->percentage > 0)
+			gpk_update_viewer_progress_apply_percentage (model, item);
+		progress_events_applied++;
+	}
+	gpk_update_viewer_progress_discard ();
+}
+
+static gboolean
+gpk_update_viewer_progress_tick_cb (GtkWidget *widget,
+				    GdkFrameClock *frame_clock,
+				    gpointer user_data)
+{
+	gpk_update_viewer_progress_flush ();
+	progress_tick_id = 0;
+	return G_SOURCE_REMOVE;
+}
+
+static void
+gpk_update_viewer_progress_queue_flush (void)
+{
+	GtkWidget *widget;
+
+	/* already waiting for the next frame */
+	if (progress_tick_id != 0)
+		return;
+	widget = GTK_WIDGET(gtk_builder_get_object (builder, "treeview_updates"));
+	progress_tick_id = gtk_widget_add_tick_callback (widget,
+							 gpk_update_viewer_progress_tick_cb,
+							 NULL, NULL);
+}
+
 static void
 gpk_update_viewer_progress_cb (PkProgress *progress,
 			       PkProgressType type,
@@ -762,12 +1060,7 @@ gpk_update_viewer_progress_cb (PkProgress *progress,
 
 	if (type == PK_PROGRESS_TYPE_PACKAGE) {
 
-		GtkTreeView *treeview;
-		GtkTreeIter iter;
-		GtkTreeModel *model;
-		GtkTreeViewColumn *column;
-		GtkTreePath *path;
-		gboolean scroll;
+		GpkUpdateViewerProgressItem *item;
 
 		/* ignore simulation phase */
 		if (pk_bitfield_contain (transaction_flags, PK_TRANSACTION_FLAG_ENUM_SIMULATE))
@@ -783,96 +1076,23 @@ gpk_update_viewer_progress_cb (PkProgress *progress,
 			      "summary", &summary,
 			      NULL);
 
-		/* find model */
-		treeview = GTK_TREE_VIEW(gtk_builder_get_object (builder, "treeview_updates"));
-		model = gtk_tree_view_get_model (treeview);
-
-		/* enable or disable the correct spinners */
-		if (role == PK_ROLE_ENUM_UPDATE_PACKAGES) {
-			path = gpk_update_viewer_model_get_path (model, package_id);
-			if (path != NULL) {
-				if (info == PK_INFO_ENUM_FINISHED)
-					gpk_update_viewer_remove_active_row (model, path);
-				else
-					gpk_update_viewer_add_active_row (model, path);
-			}
-			gtk_tree_path_free (path);
-		}
-
 		/* used for progress */
 		if (g_strcmp0 (package_id_last, package_id) != 0) {
 			g_free (package_id_last);
 			package_id_last = g_strdup (package_id);
 		}
 
-		/* update icon */
-		path = gpk_update_viewer_model_get_path (model, package_id);
-		if (path == NULL) {
-			g_autofree gchar *text = NULL;
-			text = gpk_package_id_format_twoline (gtk_widget_get_style_context (GTK_WIDGET (treeview)),
-							      package_id,
-							      summary);
-			g_debug ("adding: id=%s, text=%s", package_id, text);
-
-			/* add to model */
-			gtk_tree_store_append (array_store_updates, &iter, NULL);
-			gtk_tree_store_set (array_store_updates, &iter,
-					    GPK_UPDATES_COLUMN_TEXT, text,
-					    GPK_UPDATES_COLUMN_ID, package_id,
-					    GPK_UPDATES_COLUMN_INFO, info,
-					    GPK_UPDATES_COLUMN_SELECT, TRUE,
-					    GPK_UPDATES_COLUMN_VISIBLE, TRUE,
-					    GPK_UPDATES_COLUMN_SENSITIVE, FALSE,
-					    GPK_UPDATES_COLUMN_CLICKABLE, FALSE,
-					    GPK_UPDATES_COLUMN_RESTART, PK_RESTART_ENUM_NONE,
-					    GPK_UPDATES_COLUMN_STATUS, PK_INFO_ENUM_UNKNOWN,
-					    GPK_UPDATES_COLUMN_SIZE, 0,
-					    GPK_UPDATES_COLUMN_SIZE_DISPLAY, 0,
-					    GPK_UPDATES_COLUMN_PERCENTAGE, 0,
-					    GPK_UPDATES_COLUMN_PULSE, -1,
-					    -1);
-			path = gpk_update_viewer_model_get_path (model, package_id);
-			if (path == NULL) {
-				g_warning ("found no package %s", package_id);
-				return;
-			}
-		}
-
-		gtk_tree_model_get_iter (model, &iter, path);
-
-		/* if we are adding deps, then select the checkbox */
-		if (role == PK_ROLE_ENUM_UPDATE_PACKAGES) {
-			gtk_tree_store_set (array_store_updates, &iter,
-					    GPK_UPDATES_COLUMN_SELECT, TRUE,
-					    -1);
-		}
-
-		/* scroll to the active cell */
-		scroll = g_settings_get_boolean (settings, GPK_SETTINGS_SCROLL_ACTIVE);
-		if (scroll) {
-			column = gtk_tree_view_get_column (treeview, 3);
-			gtk_tree_view_scroll_to_cell (treeview, path, column, FALSE, 0.0f, 0.0f);
-		}
-
-		/* only change the status when we're doing the actual update */
-		if (role == PK_ROLE_ENUM_UPDATE_PACKAGES) {
-			/* if the info is finished, change the status to past tense */
-			if (info == PK_INFO_ENUM_FINISHED) {
-				/* clear the remaining size */
-				gtk_tree_store_set (array_store_updates, &iter,
-						    GPK_UPDATES_COLUMN_SIZE_DISPLAY, 0, -1);
-
-				gtk_tree_model_get (model, &iter,
-						    GPK_UPDATES_COLUMN_STATUS, &info, -1);
-				/* promote to past tense if present tense */
-				if (info < PK_INFO_ENUM_LAST)
-					info += PK_INFO_ENUM_LAST;
-			}
-			gtk_tree_store_set (array_store_updates, &iter,
-					    GPK_UPDATES_COLUMN_STATUS, info, -1);
-		}
-
-		gtk_tree_path_free (path);
+		/* only keep the latest state, the tree is updated once per frame */
+		progress_events_received++;
+		item = gpk_update_viewer_progress_item_get (package_id);
+		item->has_package = TRUE;
+		item->role = role;
+		item->info = info;
+		if (info != PK_INFO_ENUM_FINISHED)
+			item->info_active = info;
+		if (item->summary == NULL)
+			item->summary = g_steal_pointer (&summary);
+		gpk_update_viewer_progress_queue_flush ();
 
 	} else if (type == PK_PROGRESS_TYPE_STATUS) {
 
@@ -882,6 +1102,10 @@ gpk_update_viewer_progress_cb (PkProgress *progress,
 		g_autoptr(GdkCursor) cursor = NULL;
 
 		g_debug ("status %s", pk_status_enum_to_string (status));
+		if (status == PK_STATUS_ENUM_FINISHED) {
+			g_debug ("progress events: %u received, %u rows updated",
+				 progress_events_received, progress_events_applied);
+		}
 
 		/* use correct status pane */
 		widget = GTK_WIDGET(gtk_builder_get_object (builder, "hbox_status"));
@@ -935,13 +1159,8 @@ gpk_update_viewer_progress_cb (PkProgress *progress,
 
 	} else if (type == PK_PROGRESS_TYPE_ITEM_PROGRESS) {
 
-		GtkTreeView *treeview;
-		GtkTreeModel *model;
-		GtkTreeIter iter;
-		GtkTreePath *path;
-		guint size;
-		guint size_display;
-		PkItemProgress *item_progress;
+		GpkUpdateViewerProgressItem *item;
+		g_autoptr(PkItemProgress) item_progress = NULL;
 
 		/* ignore simulation phase */
 		if (pk_bitfield_contain (transaction_flags, PK_TRANSACTION_FLAG_ENUM_SIMULATE))
@@ -951,29 +1170,13 @@ gpk_update_viewer_progress_cb (PkProgress *progress,
 			      "item-progress", &item_progress,
 			      NULL);
 
-		treeview = GTK_TREE_VIEW(gtk_builder_get_object (builder, "treeview_updates"));
-		model = gtk_tree_view_get_model (treeview);
-		path = gpk_update_viewer_model_get_path (model,
-							 pk_item_progress_get_package_id (item_progress));
-		if (path == NULL) {
-			g_debug ("not found ID for %s",
-				 pk_item_progress_get_package_id (item_progress));
-			return;
-		}
-
-		gtk_tree_model_get_iter (model, &iter, path);
-		gtk_tree_model_get (model, &iter,
-				    GPK_UPDATES_COLUMN_SIZE, &size,
-				    -1);
+		progress_events_received++;
 		percentage = pk_item_progress_get_percentage (item_progress);
-		if (percentage > 0) {
-			size_display = size - ((size * percentage) / 100);
-			gtk_tree_store_set (array_store_updates, &iter,
-					    GPK_UPDATES_COLUMN_PERCENTAGE, percentage,
-					    GPK_UPDATES_COLUMN_SIZE_DISPLAY, size_display,
-					    -1);
-		}
-		gtk_tree_path_free (path);
+		if (percentage <= 0)
+			return;
+		item = gpk_update_viewer_progress_item_get (pk_item_progress_get_package_id (item_progress));
+		item->percentage = percentage;
+		gpk_update_viewer_progress_queue_flush ();
 	}
 }
 
@@ -1152,58 +1355,18 @@ gpk_update_viewer_check_mobile_broadband (void)
 	gtk_widget_show (info_mobile);
 }
 
-static void
-gpk_update_viewer_update_global_state_recursive (GtkTreeModel *model, GtkTreeIter *iter)
-{
-	gboolean selected;
-	PkRestartEnum restart;
-	guint size;
-	g_autofree gchar *package_id = NULL;
-	gboolean child_valid;
-	GtkTreeIter child_iter;
-
-	gtk_tree_model_get (model, iter,
-			    GPK_UPDATES_COLUMN_SELECT, &selected,
-			    GPK_UPDATES_COLUMN_RESTART, &restart,
-			    GPK_UPDATES_COLUMN_SIZE, &size,
-			    GPK_UPDATES_COLUMN_ID, &package_id,
-			    -1);
-	if (selected && package_id != NULL) {
-		size_total += size;
-		number_total++;
-		if (restart > restart_worst)
-			restart_worst = restart;
-	}
-
-	/* child entries */
-	child_valid = gtk_tree_model_iter_children (model, &child_iter, iter);
-	while (child_valid) {
-		gpk_update_viewer_update_global_state_recursive (model, &child_iter);
-		child_valid = gtk_tree_model_iter_next (model, &child_iter);
-	}
-}
-
 static void
 gpk_update_viewer_update_global_state (void)
-{
-	gboolean valid;
-	GtkTreeIter iter;
-	GtkTreeView *treeview;
-	GtkTreeModel *model;
-
-	/* reset to zero */
-	size_total = 0;
-	number_total = 0;
-	restart_worst = PK_RESTART_ENUM_NONE;
-
-	treeview = GTK_TREE_VIEW(gtk_builder_get_object (builder, "treeview_updates"));
-	model = gtk_tree_view_get_model (treeview);
-
-	/* if there are no entries selected, deselect the button */
-	valid = gtk_tree_model_get_iter_first (model, &iter);
-	while (valid) {
-		gpk_update_viewer_update_global_state_recursive (model, &iter);
-		valid = gtk_tree_model_iter_next (model, &iter);
+{
+	gint i;
+
+	/* the totals are kept up to date as the rows change */
+	restart_worst = PK_RESTART_ENUM_NONE;
+	for (i = PK_RESTART_ENUM_LAST - 1; i > PK_RESTART_ENUM_NONE; i--) {
+		if (restart_selected[i] > 0) {
+			restart_worst = i;
+			break;
+		}
 	}
 }
 
@@ -1599,6 +1762,193 @@ gpk_update_viewer_treeview_add_columns_update (GtkTreeView *treeview)
 	g_object_set_data (G_OBJECT (column), "tooltip-id", GINT_TO_POINTER (GPK_UPDATES_COLUMN_SIZE_DISPLAY));
 }
 
+static GtkTextBuffer *
+gpk_update_viewer_text_buffer_new (void)
+{
+	GtkTextBuffer *buffer;
+
+	/* each buffer has its own tags so the links go with it */
+	buffer = gtk_text_buffer_new (NULL);
+	gtk_text_buffer_create_tag (buffer, "para",
+				    "pixels_above_lines", 5,
+				    "wrap-mode", GTK_WRAP_WORD,
+				    NULL);
+	gtk_text_buffer_create_tag (buffer, "important",
+				    "weight", PANGO_WEIGHT_BOLD,
+				    NULL);
+	return buffer;
+}
+
+static void
+gpk_update_viewer_show_buffer (GtkTextBuffer *buffer)
+{
+	GtkWidget *widget;
+	widget = GTK_WIDGET(gtk_builder_get_object (builder, "textview_details"));
+	if (gtk_text_view_get_buffer (GTK_TEXT_VIEW (widget)) != buffer)
+		gtk_text_view_set_buffer (GTK_TEXT_VIEW (widget), buffer);
+}
+
+static void
+gpk_update_viewer_show_text (const gchar *text)
+{
+	gtk_text_buffer_set_text (text_buffer, text, -1);
+	gpk_update_viewer_show_buffer (text_buffer);
+}
+
+/* formatted descriptions, so going back to an update is instant */
+static GHashTable *description_buffers = NULL;
+static GQueue *description_order = NULL;
+
+static void
+gpk_update_viewer_description_cache_clear (void)
+{
+	g_hash_table_remove_all (description_buffers);
+	g_queue_clear (description_order);
+}
+
+static GtkTextBuffer *
+gpk_update_viewer_description_cache_lookup (const gchar *package_id)
+{
+	GList *link;
+
+	/* now the most recently used */
+	link = g_queue_find_custom (description_order, package_id, (GCompareFunc) g_strcmp0);
+	if (link == NULL)
+		return NULL;
+	g_queue_unlink (description_order, link);
+	g_queue_push_tail_link (description_order, link);
+	return g_hash_table_lookup (description_buffers, package_id);
+}
+
+static void
+gpk_update_viewer_description_cache_add (const gchar *package_id, GtkTextBuffer *buffer)
+{
+	gchar *key;
+
+	key = g_strdup (package_id);
+	g_hash_table_insert (description_buffers, key, g_object_ref (buffer));
+	g_queue_push_tail (description_order, key);
+	while (g_queue_get_length (description_order) > GPK_UPDATE_VIEWER_DESCRIPTION_CACHE) {
+		key = g_queue_pop_head (description_order);
+		g_hash_table_remove (description_buffers, key);
+	}
+}
+
+typedef struct {
+	GtkTextBuffer		*buffer;
+	GtkTextMark		*mark;
+	gchar			*text;
+	gsize			 len;
+	gsize			 offset;
+	guint			 idle_id;
+} GpkUpdateViewerChangelog;
+
+static void
+gpk_update_viewer_changelog_free (GpkUpdateViewerChangelog *changelog)
+{
+	if (changelog->idle_id != 0)
+		g_source_remove (changelog->idle_id);
+	g_free (changelog->text);
+	g_free (changelog);
+}
+
+static gboolean
+gpk_update_viewer_changelog_idle_cb (GpkUpdateViewerChangelog *changelog)
+{
+	GtkTextIter iter;
+	const gchar *text = changelog->text + changelog->offset;
+	const gchar *tmp;
+	gsize len = GPK_UPDATE_VIEWER_CHANGELOG_CHUNK;
+	gboolean valid;
+
+	/* whole lines only */
+	if (changelog->offset + len >= changelog->len) {
+		len = changelog->len - changelog->offset;
+	} else {
+		tmp = strchr (text + len, '\n');
+		if (tmp != NULL)
+			len = tmp - text + 1;
+		else
+			len = changelog->len - changelog->offset;
+	}
+
+	/* a chunk with broken markup is shown as it is, rather than parsing
+	 * ever longer prefixes looking for the end of it */
+	valid = pango_parse_markup (text, len, 0, NULL, NULL, NULL, NULL);
+	gtk_text_buffer_get_iter_at_mark (changelog->buffer, &iter, changelog->mark);
+	if (valid)
+		gtk_text_buffer_insert_markup (changelog->buffer, &iter, text, len);
+	else
+		gtk_text_buffer_insert (changelog->buffer, &iter, text, len);
+	changelog->offset += len;
+
+	/* all done */
+	if (changelog->offset < changelog->len)
+		return TRUE;
+	changelog->idle_id = 0;
+	return FALSE;
+}
+
+static void
+gpk_update_viewer_changelog_expand (GtkTextTag *tag)
+{
+	GpkUpdateViewerChangelog *changelog;
+	GtkTextIter start;
+	GtkTextIter end;
+
+	changelog = g_object_get_data (G_OBJECT (tag), "changelog");
+	if (changelog->mark != NULL)
+		return;
+
+	/* replace the link with the logs, a bit at a time */
+	gtk_text_buffer_get_start_iter (changelog->buffer, &start);
+	if (!gtk_text_iter_has_tag (&start, tag))
+		gtk_text_iter_forward_to_tag_toggle (&start, tag);
+	end = start;
+	gtk_text_iter_forward_to_tag_toggle (&end, tag);
+	gtk_text_buffer_delete (changelog->buffer, &start, &end);
+	changelog->mark = gtk_text_buffer_create_mark (changelog->buffer, NULL, &start, FALSE);
+	changelog->idle_id = g_idle_add ((GSourceFunc) gpk_update_viewer_changelog_idle_cb, changelog);
+	g_source_set_name_by_id (changelog->idle_id, "[GpkUpdateViewer] changelog");
+}
+
+static void
+gpk_update_viewer_add_changelog (GtkTextBuffer *buffer, GtkTextIter *iter, const gchar *text)
+{
+	GpkUpdateViewerChangelog *changelog;
+	GtkTextTag *tag;
+	g_autofree gchar *size = NULL;
+	g_autofree gchar *title = NULL;
+
+	/* TRANSLATORS: this is a ChangeLog */
+	gtk_text_buffer_insert (buffer, iter, _("The developer logs will be shown as no description is available for this update:"), -1);
+	gtk_text_buffer_insert (buffer, iter, "\n", -1);
+
+	/* small enough to show straight away */
+	if (strlen (text) < GPK_UPDATE_VIEWER_CHANGELOG_INLINE) {
+		gtk_text_buffer_insert_markup (buffer, iter, text, -1);
+		gtk_text_buffer_insert (buffer, iter, "\n", -1);
+		return;
+	}
+
+	/* some are hundreds of kilobytes, so only add it when asked */
+	changelog = g_new0 (GpkUpdateViewerChangelog, 1);
+	changelog->buffer = buffer;
+	changelog->text = g_strdup (text);
+	changelog->len = strlen (text);
+	tag = gtk_text_buffer_create_tag (buffer, NULL,
+					  "foreground", "blue",
+					  "underline", PANGO_UNDERLINE_SINGLE,
+					  NULL);
+	g_object_set_data_full (G_OBJECT (tag), "changelog", changelog,
+				(GDestroyNotify) gpk_update_viewer_changelog_free);
+	size = g_format_size (changelog->len);
+	/* TRANSLATORS: a link to show a large ChangeLog, e.g. "Show the developer logs (300 kB)" */
+	title = g_strdup_printf (_("Show the developer logs (%s)"), size);
+	gtk_text_buffer_insert_with_tags (buffer, iter, title, -1, tag, NULL);
+	gtk_text_buffer_insert (buffer, iter, "\n", -1);
+}
+
 static void
 gpk_update_viewer_add_description_link_item (GtkTextBuffer *buffer,
 					     GtkTextIter *iter,
@@ -1617,7 +1967,7 @@ gpk_update_viewer_add_description_link_item (GtkTextBuffer *buffer,
 						  "foreground", "blue",
 						  "underline", PANGO_UNDERLINE_SINGLE,
 						  NULL);
-		g_object_set_data (G_OBJECT (tag), "href", g_strdup (urls[i]));
+		g_object_set_data_full (G_OBJECT (tag), "href", g_strdup (urls[i]), g_free);
 		gtk_text_buffer_insert_with_tags (buffer, iter, urls[i], -1, tag, NULL);
 		gtk_text_buffer_insert (buffer, iter, ".", -1);
 	}
@@ -1648,13 +1998,13 @@ gpk_update_viewer_iso8601_format_locale_date (const gchar *iso_date)
 static void
 gpk_update_viewer_populate_details (PkUpdateDetail *item)
 {
+	GtkTextBuffer *buffer;
 	GtkTreeView *treeview;
 	GtkTreeSelection *selection;
 	GtkTreeModel *model;
 	GtkTreeIter treeiter;
 	PkInfoEnum info;
 	g_autofree gchar *line = NULL;
-	gchar *line2;
 	const gchar *title;
 	GtkTextIter iter;
 	gboolean has_update_text = FALSE;
@@ -1685,6 +2035,13 @@ gpk_update_viewer_populate_details (PkUpdateDetail *item)
 		      "updated", &updated,
 		      NULL);
 
+	/* already formatted */
+	buffer = gpk_update_viewer_description_cache_lookup (package_id);
+	if (buffer != NULL) {
+		gpk_update_viewer_show_buffer (buffer);
+		return;
+	}
+
 	/* get info  */
 	treeview = GTK_TREE_VIEW(gtk_builder_get_object (builder, "treeview_updates"));
 	selection = gtk_tree_view_get_selection (treeview);
@@ -1695,29 +2052,29 @@ gpk_update_viewer_populate_details (PkUpdateDetail *item)
 		info = PK_INFO_ENUM_NORMAL;
 
 	/* blank */
-	gtk_text_buffer_set_text (text_buffer, "", -1);
-	gtk_text_buffer_get_start_iter (text_buffer, &iter);
+	buffer = gpk_update_viewer_text_buffer_new ();
+	gtk_text_buffer_get_start_iter (buffer, &iter);
 
 	if (info == PK_INFO_ENUM_ENHANCEMENT) {
 		/* TRANSLATORS: this is the update type, e.g. security */
-		gtk_text_buffer_insert_with_tags_by_name (text_buffer, &iter, _("This update will add new features and expand functionality."), -1, "para", NULL);
-		gtk_text_buffer_insert (text_buffer, &iter, "\n", -1);
+		gtk_text_buffer_insert_with_tags_by_name (buffer, &iter, _("This update will add new features and expand functionality."), -1, "para", NULL);
+		gtk_text_buffer_insert (buffer, &iter, "\n", -1);
 	} else if (info == PK_INFO_ENUM_BUGFIX) {
 		/* TRANSLATORS: this is the update type, e.g. security */
-		gtk_text_buffer_insert_with_tags_by_name (text_buffer, &iter, _("This update will fix bugs and other non-critical problems."), -1, "para", NULL);
-		gtk_text_buffer_insert (text_buffer, &iter, "\n", -1);
+		gtk_text_buffer_insert_with_tags_by_name (buffer, &iter, _("This update will fix bugs and other non-critical problems."), -1, "para", NULL);
+		gtk_text_buffer_insert (buffer, &iter, "\n", -1);
 	} else if (info == PK_INFO_ENUM_IMPORTANT) {
 		/* TRANSLATORS: this is the update type, e.g. security */
-		gtk_text_buffer_insert_with_tags_by_name (text_buffer, &iter, _("This update is important as it may solve critical problems."), -1, "para", "important", NULL);
-		gtk_text_buffer_insert (text_buffer, &iter, "\n", -1);
+		gtk_text_buffer_insert_with_tags_by_name (buffer, &iter, _("This update is important as it may solve critical problems."), -1, "para", "important", NULL);
+		gtk_text_buffer_insert (buffer, &iter, "\n", -1);
 	} else if (info == PK_INFO_ENUM_SECURITY) {
 		/* TRANSLATORS: this is the update type, e.g. security */
-		gtk_text_buffer_insert_with_tags_by_name (text_buffer, &iter, _("This update is needed to fix a security vulnerability with this package."), -1, "para", "important", NULL);
-		gtk_text_buffer_insert (text_buffer, &iter, "\n", -1);
+		gtk_text_buffer_insert_with_tags_by_name (buffer, &iter, _("This update is needed to fix a security vulnerability with this package."), -1, "para", "important", NULL);
+		gtk_text_buffer_insert (buffer, &iter, "\n", -1);
 	} else if (info == PK_INFO_ENUM_BLOCKED) {
 		/* TRANSLATORS: this is the update type, e.g. security */
-		gtk_text_buffer_insert_with_tags_by_name (text_buffer, &iter, _("This update is blocked."), -1, "para", NULL);
-		gtk_text_buffer_insert (text_buffer, &iter, "\n", -1);
+		gtk_text_buffer_insert_with_tags_by_name (buffer, &iter, _("This update is blocked."), -1, "para", NULL);
+		gtk_text_buffer_insert (buffer, &iter, "\n", -1);
 	}
 
 	/* convert ISO time to locale time */
@@ -1729,21 +2086,21 @@ gpk_update_viewer_populate_details (PkUpdateDetail *item)
 
 		/* TRANSLATORS: this is when the notification was issued and then updated */
 		line = g_strdup_printf (_("This notification was issued on %s and last updated on %s."), issued_locale, updated_locale);
-		gtk_text_buffer_insert_with_tags_by_name (text_buffer, &iter, line, -1, "para", NULL);
-		gtk_text_buffer_insert (text_buffer, &iter, "\n", -1);
+		gtk_text_buffer_insert_with_tags_by_name (buffer, &iter, line, -1, "para", NULL);
+		gtk_text_buffer_insert (buffer, &iter, "\n", -1);
 	} else if (issued_locale != NULL) {
 
 		/* TRANSLATORS: this is when the update was issued */
 		line = g_strdup_printf (_("This notification was issued on %s."), issued_locale);
-		gtk_text_buffer_insert_with_tags_by_name (text_buffer, &iter, line, -1, "para", NULL);
-		gtk_text_buffer_insert (text_buffer, &iter, "\n", -1);
+		gtk_text_buffer_insert_with_tags_by_name (buffer, &iter, line, -1, "para", NULL);
+		gtk_text_buffer_insert (buffer, &iter, "\n", -1);
 	}
 
 	/* update text */
 	if (!_g_strzero (update_text)) {
 		if (!_g_strzero (line)) {
-			gtk_text_buffer_insert (text_buffer, &iter, update_text, -1);
-			gtk_text_buffer_insert (text_buffer, &iter, "\n\n", -1);
+			gtk_text_buffer_insert (buffer, &iter, update_text, -1);
+			gtk_text_buffer_insert (buffer, &iter, "\n\n", -1);
 			has_update_text = TRUE;
 		}
 	}
@@ -1754,54 +2111,52 @@ gpk_update_viewer_populate_details (PkUpdateDetail *item)
 		title = ngettext ("For more information about this update please visit this website:",
 				  "For more information about this update please visit these websites:",
 				  g_strv_length (vendor_urls));
-		gpk_update_viewer_add_description_link_item (text_buffer, &iter, title, vendor_urls);
+		gpk_update_viewer_add_description_link_item (buffer, &iter, title, vendor_urls);
 	}
 	if (bugzilla_urls != NULL) {
 		/* TRANSLATORS: this is a array of bugzilla URLs */
 		title = ngettext ("For more information about bugs fixed by this update please visit this website:",
 				  "For more information about bugs fixed by this update please visit these websites:",
 				  g_strv_length (bugzilla_urls));
-		gpk_update_viewer_add_description_link_item (text_buffer, &iter, title, bugzilla_urls);
+		gpk_update_viewer_add_description_link_item (buffer, &iter, title, bugzilla_urls);
 	}
 	if (cve_urls != NULL) {
 		/* TRANSLATORS: this is a array of CVE (security) URLs */
 		title = ngettext ("For more information about this security update please visit this website:",
 				  "For more information about this security update please visit these websites:",
 				  g_strv_length (cve_urls));
-		gpk_update_viewer_add_description_link_item (text_buffer, &iter, title, cve_urls);
+		gpk_update_viewer_add_description_link_item (buffer, &iter, title, cve_urls);
 	}
 
 	/* reboot */
 	if (restart == PK_RESTART_ENUM_SYSTEM) {
 		/* TRANSLATORS: reboot required */
-		gtk_text_buffer_insert_with_tags_by_name (text_buffer, &iter, _("The computer will have to be restarted after the update for the changes to take effect."), -1, "para", NULL);
-		gtk_text_buffer_insert (text_buffer, &iter, "\n", -1);
+		gtk_text_buffer_insert_with_tags_by_name (buffer, &iter, _("The computer will have to be restarted after the update for the changes to take effect."), -1, "para", NULL);
+		gtk_text_buffer_insert (buffer, &iter, "\n", -1);
 	} else if (restart == PK_RESTART_ENUM_SESSION) {
 		/* TRANSLATORS: log out required */
-		gtk_text_buffer_insert_with_tags_by_name (text_buffer, &iter, _("You will need to log out and back in after the update for the changes to take effect."), -1, "para", NULL);
-		gtk_text_buffer_insert (text_buffer, &iter, "\n", -1);
+		gtk_text_buffer_insert_with_tags_by_name (buffer, &iter, _("You will need to log out and back in after the update for the changes to take effect."), -1, "para", NULL);
+		gtk_text_buffer_insert (buffer, &iter, "\n", -1);
 	}
 
 	/* state */
 	if (state == PK_UPDATE_STATE_ENUM_UNSTABLE) {
 		/* TRANSLATORS: this is the stability status of the update */
-		gtk_text_buffer_insert_with_tags_by_name (text_buffer, &iter, _("The classification of this update is unstable which means it is not designed for production use."), -1, "para", NULL);
-		gtk_text_buffer_insert (text_buffer, &iter, "\n", -1);
+		gtk_text_buffer_insert_with_tags_by_name (buffer, &iter, _("The classification of this update is unstable which means it is not designed for production use."), -1, "para", NULL);
+		gtk_text_buffer_insert (buffer, &iter, "\n", -1);
 	} else if (state == PK_UPDATE_STATE_ENUM_TESTING) {
 		/* TRANSLATORS: this is the stability status of the update */
-		gtk_text_buffer_insert_with_tags_by_name (text_buffer, &iter, _("This is a test update, and is not designed for normal use. Please report any problems or regressions you encounter."), -1, "para", NULL);
-		gtk_text_buffer_insert (text_buffer, &iter, "\n", -1);
+		gtk_text_buffer_insert_with_tags_by_name (buffer, &iter, _("This is a test update, and is not designed for normal use. Please report any problems or regressions you encounter."), -1, "para", NULL);
+		gtk_text_buffer_insert (buffer, &iter, "\n", -1);
 	}
 
 	/* only show changelog if we didn't have any update text */
-	if (!has_update_text && !_g_strzero (changelog)) {
-		if (!_g_strzero (changelog)) {
-			/* TRANSLATORS: this is a ChangeLog */
-			line2 = g_strdup_printf ("%s\n%s\n", _("The developer logs will be shown as no description is available for this update:"), changelog);
-			gtk_text_buffer_insert_markup (text_buffer, &iter, line2, -1);
-			g_free (line2);
-		}
-	}
+	if (!has_update_text && !_g_strzero (changelog))
+		gpk_update_viewer_add_changelog (buffer, &iter, changelog);
+
+	gpk_update_viewer_description_cache_add (package_id, buffer);
+	gpk_update_viewer_show_buffer (buffer);
+	g_object_unref (buffer);
 }
 
 static void
@@ -1827,14 +2182,84 @@ gpk_packages_treeview_clicked_cb (GtkTreeSelection *selection, gpointer user_dat
 	widget = GTK_WIDGET(gtk_builder_get_object (builder, "expander1"));
 	gtk_widget_set_sensitive (widget, package_id != NULL);
 
-	/* set loading text */
+	/* show the description */
 	if (item != NULL) {
 		g_debug ("selected row is: %s, %p", package_id, item);
-		gtk_text_buffer_set_text (text_buffer, _("Loading…"), -1);
 		gpk_update_viewer_populate_details (item);
 	} else {
-		gtk_text_buffer_set_text (text_buffer, _("No update details available."), -1);
+		gpk_update_viewer_show_text (_("No update details available."));
+	}
+}
+
+/* package IDs still waiting for details, the visible rows first */
+static GQueue *details_queue = NULL;
+static guint details_in_flight = 0;
+static guint details_generation = 0;
+
+static void
+gpk_update_viewer_details_queue_clear (void)
+{
+	gchar *package_id;
+
+	/* replies for the old rows are ignored */
+	while ((package_id = g_queue_pop_head (details_queue)) != NULL)
+		g_free (package_id);
+	details_in_flight = 0;
+	details_generation++;
+}
+
+static void
+gpk_update_viewer_details_queue_fill (void)
+{
+	gboolean have_range;
+	gboolean valid;
+	gboolean valid_child;
+	GtkTreeIter iter;
+	GtkTreeIter child;
+	GtkTreeModel *model;
+	GtkTreePath *end = NULL;
+	GtkTreePath *path;
+	GtkTreePath *start = NULL;
+	GtkTreeView *treeview;
+	guint i;
+	g_autoptr(GPtrArray) hidden = NULL;
+
+	/* if the view has not been drawn yet then the top rows are the ones
+	 * that will be visible */
+	treeview = GTK_TREE_VIEW(gtk_builder_get_object (builder, "treeview_updates"));
+	model = gtk_tree_view_get_model (treeview);
+	have_range = gtk_tree_view_get_visible_range (treeview, &start, &end);
+
+	/* updates are the children of the update type headers */
+	hidden = g_ptr_array_new ();
+	valid = gtk_tree_model_get_iter_first (model, &iter);
+	while (valid) {
+		valid_child = gtk_tree_model_iter_children (model, &child, &iter);
+		while (valid_child) {
+			gchar *package_id = NULL;
+			gtk_tree_model_get (model, &child,
+					    GPK_UPDATES_COLUMN_ID, &package_id,
+					    -1);
+			path = gtk_tree_model_get_path (model, &child);
+			if (!have_range ||
+			    (gtk_tree_path_compare (path, start) >= 0 &&
+			     gtk_tree_path_compare (path, end) <= 0)) {
+				g_queue_push_tail (details_queue, package_id);
+			} else {
+				g_ptr_array_add (hidden, package_id);
+			}
+			gtk_tree_path_free (path);
+			valid_child = gtk_tree_model_iter_next (model, &child);
+		}
+		valid = gtk_tree_model_iter_next (model, &iter);
 	}
+	for (i = 0; i < hidden->len; i++)
+		g_queue_push_tail (details_queue, g_ptr_array_index (hidden, i));
+
+	if (start != NULL)
+		gtk_tree_path_free (start);
+	if (end != NULL)
+		gtk_tree_path_free (end);
 }
 
 static void
@@ -1857,10 +2282,14 @@ gpk_update_viewer_get_details_cb (PkClient *client, GAsyncResult *res, gpointer
 
 	/* get the results */
 	results = pk_client_generic_finish (client, res, &error);
+
+	/* the update list has been refreshed since */
+	if (GPOINTER_TO_UINT (user_data) != details_generation)
+		return;
 	if (results == NULL) {
 		/* TRANSLATORS: the PackageKit request did not complete, and it did not send an error */
 		gpk_update_viewer_error_dialog (_("Could not get update details"), NULL, error->message);
-		return;
+		goto out;
 	}
 
 	/* check error code */
@@ -1871,7 +2300,7 @@ gpk_update_viewer_get_details_cb (PkClient *client, GAsyncResult *res, gpointer
 		window = GTK_WINDOW(gtk_builder_get_object (builder, "dialog_updates"));
 		gpk_error_dialog_modal (window, gpk_error_enum_to_localised_text (pk_error_get_code (error_code)),
 					gpk_error_enum_to_localised_message (pk_error_get_code (error_code)), pk_error_get_details (error_code));
-		return;
+		goto out;
 	}
 
 	/* get data */
@@ -1879,7 +2308,7 @@ gpk_update_viewer_get_details_cb (PkClient *client, GAsyncResult *res, gpointer
 	if (array->len == 0) {
 		/* TRANSLATORS: PackageKit did not send any results for the query... */
 		gpk_update_viewer_error_dialog (_("Could not get package details"), _("No results were returned."), NULL);
-		return;
+		goto out;
 	}
 
 	/* set data */
@@ -1916,13 +2345,19 @@ gpk_update_viewer_get_details_cb (PkClient *client, GAsyncResult *res, gpointer
 	/* select the first entry in the updates array now we've got data */
 	widget = GTK_WIDGET(gtk_builder_get_object (builder, "treeview_updates"));
 	selection = gtk_tree_view_get_selection (GTK_TREE_VIEW(widget));
-	gtk_tree_selection_unselect_all (selection);
-	path = gtk_tree_path_new_first ();
-	gtk_tree_selection_select_path (selection, path);
-	gtk_tree_path_free (path);
+	if (gtk_tree_selection_count_selected_rows (selection) == 0) {
+		path = gtk_tree_path_new_first ();
+		gtk_tree_selection_select_path (selection, path);
+		gtk_tree_path_free (path);
+	}
 
 	/* set info */
 	gpk_update_viewer_reconsider_info ();
+	gpk_update_viewer_details_chunk_done ();
+	return;
+out:
+	/* don't ask for the rest if this failed */
+	gpk_update_viewer_details_queue_clear ();
 }
 
 static void
@@ -1933,6 +2368,8 @@ gpk_update_viewer_get_update_detail_cb (PkClient *client, GAsyncResult *res, gpo
 	g_autoptr(GPtrArray) array = NULL;
 	PkUpdateDetail *item;
 	guint i;
+	gboolean selected_changed = FALSE;
+	GtkTreeSelection *selection;
 	GtkTreeView *treeview;
 	GtkTreeModel *model;
 	GtkTreeIter iter;
@@ -1940,13 +2377,18 @@ gpk_update_viewer_get_update_detail_cb (PkClient *client, GAsyncResult *res, gpo
 	g_autoptr(PkError) error_code = NULL;
 	GtkWindow *window;
 	PkRestartEnum restart;
+	g_autofree gchar *package_id_selected = NULL;
 
 	/* get the results */
 	results = pk_client_generic_finish (client, res, &error);
+
+	/* the update list has been refreshed since */
+	if (GPOINTER_TO_UINT (user_data) != details_generation)
+		return;
 	if (results == NULL) {
 		/* TRANSLATORS: the PackageKit request did not complete, and it did not send an error */
 		gpk_update_viewer_error_dialog (_("Could not get update details"), NULL, error->message);
-		return;
+		goto out;
 	}
 
 	/* check error code */
@@ -1957,7 +2399,7 @@ gpk_update_viewer_get_update_detail_cb (PkClient *client, GAsyncResult *res, gpo
 		window = GTK_WINDOW(gtk_builder_get_object (builder, "dialog_updates"));
 		gpk_error_dialog_modal (window, gpk_error_enum_to_localised_text (pk_error_get_code (error_code)),
 					gpk_error_enum_to_localised_message (pk_error_get_code (error_code)), pk_error_get_details (error_code));
-		return;
+		goto out;
 	}
 
 	/* get data */
@@ -1965,12 +2407,20 @@ gpk_update_viewer_get_update_detail_cb (PkClient *client, GAsyncResult *res, gpo
 	if (array->len == 0) {
 		/* TRANSLATORS: PackageKit did not send any results for the query... */
 		gpk_update_viewer_error_dialog (_("Could not get update details"), _("No results were returned."), NULL);
-		return;
+		goto out;
 	}
 
-	/* add data */
+	/* the selected row might be waiting for this */
 	treeview = GTK_TREE_VIEW(gtk_builder_get_object (builder, "treeview_updates"));
 	model = gtk_tree_view_get_model (treeview);
+	selection = gtk_tree_view_get_selection (treeview);
+	if (gtk_tree_selection_get_selected (selection, NULL, &iter)) {
+		gtk_tree_model_get (model, &iter,
+				    GPK_UPDATES_COLUMN_ID, &package_id_selected,
+				    -1);
+	}
+
+	/* add data */
 	for (i = 0; i < array->len; i++) {
 		g_autofree gchar *package_id = NULL;
 		item = g_ptr_array_index (array, i);
@@ -1990,8 +2440,60 @@ gpk_update_viewer_get_update_detail_cb (PkClient *client, GAsyncResult *res, gpo
 			gtk_tree_store_set (array_store_updates, &iter,
 					    GPK_UPDATES_COLUMN_UPDATE_DETAIL_OBJ, (gpointer) g_object_ref (item),
 					    GPK_UPDATES_COLUMN_RESTART, restart, -1);
+			if (g_strcmp0 (package_id, package_id_selected) == 0)
+				selected_changed = TRUE;
 		}
 	}
+	if (selected_changed)
+		gpk_packages_treeview_clicked_cb (selection, NULL);
+
+	/* the restart icon may have changed */
+	gpk_update_viewer_reconsider_info ();
+	gpk_update_viewer_details_chunk_done ();
+	return;
+out:
+	/* don't ask for the rest if this failed */
+	gpk_update_viewer_details_queue_clear ();
+}
+
+static void
+gpk_update_viewer_details_send_chunk (void)
+{
+	gchar *package_id;
+	g_autoptr(GPtrArray) package_ids = NULL;
+
+	/* one chunk at a time so the visible rows are done first */
+	if (details_in_flight > 0)
+		return;
+	package_ids = g_ptr_array_new_with_free_func (g_free);
+	while (package_ids->len < GPK_UPDATE_VIEWER_DETAILS_CHUNK &&
+	       (package_id = g_queue_pop_head (details_queue)) != NULL)
+		g_ptr_array_add (package_ids, package_id);
+	if (package_ids->len == 0)
+		return;
+	g_debug ("getting details for %u updates, %u to go",
+		 package_ids->len, g_queue_get_length (details_queue));
+	g_ptr_array_add (package_ids, NULL);
+
+	/* get the restart type and the download size */
+	details_in_flight = 2;
+	pk_client_get_update_detail_async (PK_CLIENT(task), (gchar **) package_ids->pdata, cancellable,
+					   (PkProgressCallback) gpk_update_viewer_progress_cb, NULL,
+					   (GAsyncReadyCallback) gpk_update_viewer_get_update_detail_cb,
+					   GUINT_TO_POINTER (details_generation));
+	pk_client_get_details_async (PK_CLIENT(task), (gchar **) package_ids->pdata, cancellable,
+				     (PkProgressCallback) gpk_update_viewer_progress_cb, NULL,
+				     (GAsyncReadyCallback) gpk_update_viewer_get_details_cb,
+				     GUINT_TO_POINTER (details_generation));
+}
+
+static void
+gpk_update_viewer_details_chunk_done (void)
+{
+	/* wait for the other half of the chunk */
+	if (--details_in_flight > 0)
+		return;
+	gpk_update_viewer_details_send_chunk ();
 }
 
 static void
@@ -2246,31 +2748,11 @@ gpk_update_viewer_detail_popup_menu (GtkWidget *treeview, gpointer user_data)
 	return TRUE;
 }
 
-static gchar **
-gpk_update_viewer_packages_to_ids (GPtrArray *array)
-{
-	guint i;
-	gchar **value;
-	PkPackage *item;
-	const gchar *package_id;
-
-	value = g_new0 (gchar *, array->len + 1);
-	for (i = 0; i < array->len; i++) {
-		item = g_ptr_array_index (array, i);
-		package_id = pk_package_get_id (item);
-		value[i] = g_strdup (package_id);
-	}
-	return value;
-}
-
 static void
-gpk_update_viewer_get_updates_cb (PkClient *client, GAsyncResult *res, gpointer user_data)
+gpk_update_viewer_get_updates_format_cb (GObject *object, GAsyncResult *res, gpointer user_data)
 {
-	g_autoptr(PkResults) results = NULL;
-	g_autoptr(PkPackageSack) sack = NULL;
 	g_autoptr(GError) error = NULL;
-	g_autoptr(GPtrArray) array = NULL;
-	g_autoptr(GPtrArray) array_messages = NULL;
+	g_autoptr(GPtrArray) markup = NULL;
 	PkPackage *item;
 	gboolean selected;
 	gboolean sensitive;
@@ -2280,54 +2762,36 @@ gpk_update_viewer_get_updates_cb (PkClient *client, GAsyncResult *res, gpointer
 	GtkTreeView *treeview;
 	GtkTreeModel *model;
 	GtkWidget *widget;
-	g_autoptr(PkError) error_code = NULL;
-	GtkWindow *window;
 	PkInfoEnum info;
 
-	/* get the results */
-	results = pk_client_generic_finish (client, res, &error);
-	if (results == NULL) {
-		/* TRANSLATORS: the PackageKit request did not complete, and it did not send an error */
-		gpk_update_viewer_error_dialog (_("Could not get updates"), NULL, error->message);
+	markup = gpk_markup_formatter_format_finish (GPK_MARKUP_FORMATTER (object), res, &error);
+	if (markup == NULL) {
+		if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+			g_warning ("failed to format updates: %s", error->message);
 		return;
 	}
 
-	/* check error code */
-	error_code = pk_results_get_error_code (results);
-	if (error_code != NULL) {
-		g_warning ("failed to get updates: %s, %s", pk_error_enum_to_string (pk_error_get_code (error_code)), pk_error_get_details (error_code));
-
-		window = GTK_WINDOW(gtk_builder_get_object (builder, "dialog_updates"));
-		gpk_error_dialog_modal (window, gpk_error_enum_to_localised_text (pk_error_get_code (error_code)),
-					gpk_error_enum_to_localised_message (pk_error_get_code (error_code)), pk_error_get_details (error_code));
+	/* the updates have been refreshed since */
+	if (GPOINTER_TO_UINT (user_data) != details_generation ||
+	    markup->len != update_array->len)
 		return;
-	}
 
-	/* get data */
-	sack = pk_results_get_package_sack (results);
-	pk_package_sack_sort (sack, PK_PACKAGE_SACK_SORT_TYPE_NAME);
-	array = pk_package_sack_get_array (sack);
-	widget = GTK_WIDGET(gtk_builder_get_object (builder, "treeview_updates"));
-	for (i = 0; i < array->len; i++) {
-		g_autofree gchar *text = NULL;
+	for (i = 0; i < update_array->len; i++) {
+		const gchar *text;
 		g_autofree gchar *package_id = NULL;
-		g_autofree gchar *summary = NULL;
-		item = g_ptr_array_index (array, i);
+		item = g_ptr_array_index (update_array, i);
 
 		/* get data */
 		g_object_get (item,
 			      "info", &info,
 			      "package-id", &package_id,
-			      "summary", &summary,
 			      NULL);
 
 		/* find our parent */
 		gpk_update_viewer_get_parent_for_info (info, &parent);
 
 		/* add to array store */
-		text = gpk_package_id_format_twoline (gtk_widget_get_style_context (widget),
-						      package_id,
-						      summary);
+		text = g_ptr_array_index (markup, i);
 		g_debug ("adding: id=%s, text=%s", package_id, text);
 		selected = (info != PK_INFO_ENUM_BLOCKED);
 
@@ -2356,13 +2820,10 @@ gpk_update_viewer_get_updates_cb (PkClient *client, GAsyncResult *res, gpointer
 				    GPK_UPDATES_COLUMN_PERCENTAGE, 0,
 				    GPK_UPDATES_COLUMN_PULSE, -1,
 				    -1);
+		gpk_update_viewer_model_add_row (GTK_TREE_MODEL (array_store_updates),
+						 &iter, package_id);
 	}
 
-	/* get the download sizes */
-	if (update_array != NULL)
-		g_ptr_array_unref (update_array);
-	update_array = pk_results_get_package_array (results);
-
 	/* sort by name */
 	treeview = GTK_TREE_VIEW(gtk_builder_get_object (builder, "treeview_updates"));
 	model = gtk_tree_view_get_model (treeview);
@@ -2371,20 +2832,10 @@ gpk_update_viewer_get_updates_cb (PkClient *client, GAsyncResult *res, gpointer
 					      GTK_SORT_DESCENDING);
 	gtk_tree_view_expand_all (treeview);
 
-	/* get the download sizes */
+	/* get the details in chunks, starting with the rows that can be seen */
 	if (update_array->len > 0) {
-		g_auto(GStrv) package_ids = NULL;
-		package_ids = gpk_update_viewer_packages_to_ids (array);
-
-		/* get the details of all the packages */
-		pk_client_get_update_detail_async (PK_CLIENT(task), package_ids, cancellable,
-						   (PkProgressCallback) gpk_update_viewer_progress_cb, NULL,
-						   (GAsyncReadyCallback) gpk_update_viewer_get_update_detail_cb, NULL);
-
-		/* get the details of all the packages */
-		pk_client_get_details_async (PK_CLIENT(task), package_ids, cancellable,
-					     (PkProgressCallback) gpk_update_viewer_progress_cb, NULL,
-					     (GAsyncReadyCallback) gpk_update_viewer_get_details_cb, NULL);
+		gpk_update_viewer_details_queue_fill ();
+		gpk_update_viewer_details_send_chunk ();
 	}
 
 	/* are now able to do action */
@@ -2395,6 +2846,49 @@ gpk_update_viewer_get_updates_cb (PkClient *client, GAsyncResult *res, gpointer
 	gpk_update_viewer_reconsider_info ();
 }
 
+static void
+gpk_update_viewer_get_updates_cb (PkClient *client, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(PkResults) results = NULL;
+	g_autoptr(PkPackageSack) sack = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) array = NULL;
+	g_autoptr(PkError) error_code = NULL;
+	GtkWindow *window;
+
+	/* get the results */
+	results = pk_client_generic_finish (client, res, &error);
+	if (results == NULL) {
+		/* TRANSLATORS: the PackageKit request did not complete, and it did not send an error */
+		gpk_update_viewer_error_dialog (_("Could not get updates"), NULL, error->message);
+		return;
+	}
+
+	/* check error code */
+	error_code = pk_results_get_error_code (results);
+	if (error_code != NULL) {
+		g_warning ("failed to get updates: %s, %s", pk_error_enum_to_string (pk_error_get_code (error_code)), pk_error_get_details (error_code));
+
+		window = GTK_WINDOW(gtk_builder_get_object (builder, "dialog_updates"));
+		gpk_error_dialog_modal (window, gpk_error_enum_to_localised_text (pk_error_get_code (error_code)),
+					gpk_error_enum_to_localised_message (pk_error_get_code (error_code)), pk_error_get_details (error_code));
+		return;
+	}
+
+	/* get data */
+	sack = pk_results_get_package_sack (results);
+	pk_package_sack_sort (sack, PK_PACKAGE_SACK_SORT_TYPE_NAME);
+	array = pk_package_sack_get_array (sack);
+
+	/* the markup is formatted on a thread, so only the inserts are done here */
+	if (update_array != NULL)
+		g_ptr_array_unref (update_array);
+	update_array = g_ptr_array_ref (array);
+	gpk_markup_formatter_format_async (formatter, array, cancellable,
+					   gpk_update_viewer_get_updates_format_cb,
+					   GUINT_TO_POINTER (details_generation));
+}
+
 static gboolean
 gpk_update_viewer_get_new_update_array (void)
 {
@@ -2404,8 +2898,9 @@ gpk_update_viewer_get_new_update_array (void)
 	PkBitfield filter = PK_FILTER_ENUM_NONE;
 
 	/* clear all widgets */
-	gtk_tree_store_clear (array_store_updates);
-	gtk_text_buffer_set_text (text_buffer, "", -1);
+	gpk_update_viewer_model_clear ();
+	gpk_update_viewer_description_cache_clear ();
+	gpk_update_viewer_show_text ("");
 
 	widget = GTK_WIDGET(gtk_builder_get_object (builder, "label_header_title"));
 	/* TRANSLATORS: this is the header */
@@ -2444,6 +2939,8 @@ gpk_update_viewer_textview_follow_link (GtkWidget *text_view, GtkTextIter *iter)
 		const gchar *href = (const gchar *) (g_object_get_data (G_OBJECT (tag), "href"));
 		if (href != NULL)
 			gtk_show_uri (NULL, href, GDK_CURRENT_TIME, NULL);
+		if (g_object_get_data (G_OBJECT (tag), "changelog") != NULL)
+			gpk_update_viewer_changelog_expand (tag);
 	}
 
 	if (tags != NULL)
@@ -2523,7 +3020,7 @@ gpk_update_viewer_textview_set_cursor (GtkTextView *text_view, gint x, gint y)
 	for (tagp = tags; tagp != NULL; tagp = tagp->next) {
 		GtkTextTag *tag = tagp->data;
 		const gchar *href = (const gchar *) g_object_get_data (G_OBJECT (tag), "href");
-		if (href != NULL) {
+		if (href != NULL || g_object_get_data (G_OBJECT (tag), "changelog") != NULL) {
 			hovering = TRUE;
 			break;
 		}
@@ -2795,14 +3292,22 @@ gpk_update_viewer_application_startup_cb (GtkApplication *_application, gpointer
 						 G_TYPE_BOOLEAN, G_TYPE_BOOLEAN, G_TYPE_BOOLEAN,
 						 G_TYPE_UINT, G_TYPE_UINT, G_TYPE_UINT, G_TYPE_UINT,
 						 G_TYPE_UINT, G_TYPE_POINTER, G_TYPE_POINTER, G_TYPE_INT, G_TYPE_BOOLEAN);
-	text_buffer = gtk_text_buffer_new (NULL);
-	gtk_text_buffer_create_tag (text_buffer, "para",
-				    "pixels_above_lines", 5,
-				    "wrap-mode", GTK_WRAP_WORD,
-				    NULL);
-	gtk_text_buffer_create_tag (text_buffer, "important",
-				    "weight", PANGO_WEIGHT_BOLD,
-				    NULL);
+	array_store_rows = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+						  (GDestroyNotify) gtk_tree_row_reference_free);
+	row_states = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+	g_signal_connect (array_store_updates, "row-inserted",
+			  G_CALLBACK (gpk_update_viewer_row_changed_cb), NULL);
+	g_signal_connect (array_store_updates, "row-changed",
+			  G_CALLBACK (gpk_update_viewer_row_changed_cb), NULL);
+	progress_pending = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+						  (GDestroyNotify) gpk_update_viewer_progress_item_free);
+	progress_pending_order = g_ptr_array_new ();
+	active_rows = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	details_queue = g_queue_new ();
+	text_buffer = gpk_update_viewer_text_buffer_new ();
+	description_buffers = g_hash_table_new_full (g_str_hash, g_str_equal,
+						     g_free, g_object_unref);
+	description_order = g_queue_new ();
 
 	/* no upgrades yet */
 	widget = GTK_WIDGET(gtk_builder_get_object (builder, "viewport_upgrade"));
@@ -2832,6 +3337,8 @@ gpk_update_viewer_application_startup_cb (GtkApplication *_application, gpointer
 			  G_CALLBACK (gpk_update_viewer_detail_popup_menu), NULL);
 	g_signal_connect (widget, "button-press-event",
 			  G_CALLBACK (gpk_update_viewer_detail_button_pressed), NULL);
+	formatter = gpk_markup_formatter_new ();
+	gpk_markup_formatter_set_widget (formatter, widget);
 
 	/* selection */
 	selection = gtk_tree_view_get_selection (GTK_TREE_VIEW(widget));
@@ -2970,6 +3477,20 @@ main (int argc, char *argv[])
 	if (update_array != NULL)
 		g_ptr_array_unref (update_array);
 	g_free (package_id_last);
+	if (active_row_timeout_id != 0)
+		g_source_remove (active_row_timeout_id);
+	if (active_rows != NULL)
+		g_hash_table_unref (active_rows);
+	if (details_queue != NULL)
+		g_queue_free_full (details_queue, g_free);
+	if (progress_pending_order != NULL)
+		g_ptr_array_unref (progress_pending_order);
+	if (progress_pending != NULL)
+		g_hash_table_unref (progress_pending);
+	if (array_store_rows != NULL)
+		g_hash_table_unref (array_store_rows);
+	if (row_states != NULL)
+		g_hash_table_unref (row_states);
 	if (array_store_updates != NULL)
 		g_object_unref (array_store_updates);
 	if (builder != NULL)
@@ -2988,6 +3509,12 @@ main (int argc, char *argv[])
 		g_object_unref (task);
 	if (text_buffer != NULL)
 		g_object_unref (text_buffer);
+	if (description_buffers != NULL)
+		g_hash_table_unref (description_buffers);
+	if (description_order != NULL)
+		g_queue_free (description_order);
+	if (formatter != NULL)
+		g_object_unref (formatter);
 
 	g_object_unref (application);
 	return status;